@@ -0,0 +1,69 @@
+///////////////////////////////////////////////////////////////////////////////
+// food_generator.cc
+//
+// Write a synthetic food database in the format of food.csv.
+//
+//   food_generator ROWS [DISTRIBUTION] [SEED] [OUTPUT]
+//
+// DISTRIBUTION is pantry (the default), correlated, inverse_correlated, or
+// subset_sum; SEED defaults to 1; OUTPUT defaults to standard output.
+// The same arguments always produce the same file.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "food_generator.hh"
+
+using namespace std;
+
+bool parse_count(const char* text, uint64_t& output)
+{
+  const char* end = text + strlen(text);
+  auto result = from_chars(text, end, output);
+  return result.ec == errc() && result.ptr == end;
+}
+
+int main(int argc, char* argv[])
+{
+  uint64_t rows = 0, seed = 1;
+  FoodDistribution distribution = FoodDistribution::pantry;
+
+  if ( argc < 2 || argc > 5
+       || ! parse_count(argv[1], rows)
+       || ( argc > 2 && ! parse_food_distribution(argv[2], distribution) )
+       || ( argc > 3 && ! parse_count(argv[3], seed) ) )
+  {
+    cerr << "usage: " << argv[0]
+         << " ROWS [pantry|correlated|inverse_correlated|subset_sum] [SEED] [OUTPUT]" << endl;
+    return 1;
+  }
+
+  FoodGenerator generator(distribution, seed);
+
+  bool written;
+  if ( argc > 4 && strcmp(argv[4], "-") != 0 )
+  {
+    ofstream file(argv[4], ios::binary);
+    written = file && write_food_dataset(file, generator, 0, rows);
+    file.close();
+    written = written && file;
+  }
+  else
+  {
+    ios::sync_with_stdio(false);
+    written = write_food_dataset(cout, generator, 0, rows) && cout.flush();
+  }
+
+  if ( ! written )
+  {
+    cerr << "Cannot write food database" << endl;
+    return 1;
+  }
+
+  return 0;
+}
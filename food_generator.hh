@@ -0,0 +1,278 @@
+///////////////////////////////////////////////////////////////////////////////
+// food_generator.hh
+//
+// Synthetic food databases in the Item^Weight^Calorie format of food.csv,
+// at any size, for benchmarking the loaders and solvers in maxcalorie.hh.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "maxcalorie.hh"
+
+
+// How weights and calories are drawn.
+//
+// pantry mimics food.csv: normally distributed weights (mean 438.7,
+// standard deviation 208.6) and calories that follow weight with the
+// same spread and correlation (0.80) as the real data, including the odd
+// negative calorie count.
+//
+// The other three are the classic hard knapsack families, with weights
+// drawn uniformly from [1, range] ounces:
+//  correlated          calories = weight + range / 10
+//  inverse_correlated  weight = calories + range / 10, calories uniform
+//  subset_sum          calories = weight
+enum class FoodDistribution
+{
+	pantry,
+	correlated,
+	inverse_correlated,
+	subset_sum
+};
+
+const char* food_distribution_name(FoodDistribution distribution)
+{
+	switch ( distribution )
+	{
+		case FoodDistribution::pantry: return "pantry";
+		case FoodDistribution::correlated: return "correlated";
+		case FoodDistribution::inverse_correlated: return "inverse_correlated";
+		case FoodDistribution::subset_sum: return "subset_sum";
+	}
+	return "unknown";
+}
+
+bool parse_food_distribution(std::string_view name, FoodDistribution& output)
+{
+	for ( FoodDistribution distribution : { FoodDistribution::pantry, FoodDistribution::correlated,
+		FoodDistribution::inverse_correlated, FoodDistribution::subset_sum } )
+	{
+		if ( name == food_distribution_name(distribution) )
+		{
+			output = distribution;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+// The words of food.csv's descriptions, with the number of times each
+// occurs there.
+struct FoodWordFrequency
+{
+	const char* word;
+	uint32_t count;
+};
+
+constexpr FoodWordFrequency FOOD_WORDS[] = {
+	{ "with", 4464 }, { "beans", 2736 }, { "refried", 2688 }, { "Chinese", 2688 },
+	{ "shredded", 1632 }, { "chicken", 1524 }, { "turkey", 1344 }, { "spicy", 1344 },
+	{ "cheese", 1344 }, { "baked", 1344 }, { "light", 1260 }, { "beef", 1260 },
+	{ "vegetables", 1152 }, { "little", 1152 }, { "green", 1152 }, { "eggs", 1152 },
+	{ "mild", 1008 }, { "delicious", 1008 }, { "cookies", 1008 }, { "chunky", 1008 },
+	{ "MSG-free", 1008 }, { "rice", 864 }, { "pork", 864 }, { "pickled", 864 },
+	{ "breast", 847 }, { "gravy", 576 }, { "bacon", 576 }, { "whole", 288 },
+	{ "potatoes", 288 }, { "pasta", 288 }, { "nuggets", 288 }, { "mansion", 288 },
+	{ "lasagna", 288 }, { "garbanzo", 288 }, { "corn", 288 }, { "chocolate", 288 },
+	{ "drumsticks", 180 }
+};
+
+// How many of food.csv's descriptions have 1, 2, ... 8 words.
+constexpr uint32_t FOOD_DESCRIPTION_LENGTHS[] = { 6, 115, 673, 1783, 2415, 2377, 645, 50 };
+
+
+// Row i of a generated database depends only on the seed and i, so any
+// slice of a large file can be regenerated, or generated in parallel,
+// without producing the rows before it. Values are fixed-point
+// hundredths like FixedFoodTable and the random stream is splitmix64, so
+// descriptions and the uniform distributions (correlated,
+// inverse_correlated, subset_sum) are the same with every compiler and
+// standard library. pantry's normal draws go through std::log, std::sqrt
+// and std::cos, which are not correctly rounded, so a different libm can
+// round an occasional pantry weight or calorie count the other way.
+class FoodGenerator
+{
+	public:
+		FoodGenerator(FoodDistribution distribution, uint64_t seed, FoodCenti range = 100000)
+			: _distribution(distribution), _seed(seed), _range(std::max<FoodCenti>(range, 100))
+		{
+			for ( const auto& entry : FOOD_WORDS )
+			{
+				_word_total += entry.count;
+			}
+			for ( uint32_t count : FOOD_DESCRIPTION_LENGTHS )
+			{
+				_length_total += count;
+			}
+		}
+
+		FoodDistribution distribution() const { return _distribution; }
+		uint64_t seed() const { return _seed; }
+		FoodCenti range() const { return _range; }
+
+		// Replace description, weight, and calories with row i.
+		void row(uint64_t i, std::string& description, FoodCenti& weight, FoodCenti& calories) const
+		{
+			uint64_t state = mix(_seed ^ mix(i + 0x632be59bd9b4e019ULL));
+
+			description.clear();
+			size_t words = 1 + pick(state, FOOD_DESCRIPTION_LENGTHS, _length_total,
+				[](uint32_t count) { return count; });
+			for ( size_t w = 0; w < words; w++ )
+			{
+				if ( w > 0 )
+				{
+					description += ' ';
+				}
+				description += FOOD_WORDS[pick(state, FOOD_WORDS, _word_total,
+					[](const FoodWordFrequency& entry) { return entry.count; })].word;
+			}
+
+			const FoodCenti tenth = _range / 10;
+			switch ( _distribution )
+			{
+				case FoodDistribution::pantry:
+				{
+					double ounces = std::max(1.0, 438.7 + 208.6 * normal(state));
+					weight = FoodCenti(std::llround(ounces * 100));
+					calories = FoodCenti(std::llround((71.7 + 0.756 * ounces + 118.2 * normal(state)) * 100));
+					break;
+				}
+				case FoodDistribution::correlated:
+					weight = uniform(state, 100, _range);
+					calories = weight + tenth;
+					break;
+				case FoodDistribution::inverse_correlated:
+					calories = uniform(state, 100, _range);
+					weight = calories + tenth;
+					break;
+				case FoodDistribution::subset_sum:
+					weight = uniform(state, 100, _range);
+					calories = weight;
+					break;
+			}
+		}
+
+	private:
+		static uint64_t mix(uint64_t z)
+		{
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+			return z ^ (z >> 31);
+		}
+
+		static uint64_t next(uint64_t& state)
+		{
+			state += 0x9e3779b97f4a7c15ULL;
+			return mix(state);
+		}
+
+		// In [0, 1).
+		static double unit(uint64_t& state)
+		{
+			return double(next(state) >> 11) * (1.0 / 9007199254740992.0);
+		}
+
+		// Box-Muller; one draw per call keeps each row's stream simple.
+		static double normal(uint64_t& state)
+		{
+			double u = 1.0 - unit(state);
+			double v = unit(state);
+			return std::sqrt(-2.0 * std::log(u)) * std::cos(6.283185307179586 * v);
+		}
+
+		// In [low, high].
+		static FoodCenti uniform(uint64_t& state, FoodCenti low, FoodCenti high)
+		{
+			return low + FoodCenti(next(state) % uint64_t(high - low + 1));
+		}
+
+		// An index into entries, drawn with probability proportional to
+		// count_of(entry); total is the sum of the counts.
+		template <typename Entries, typename CountOf>
+		static size_t pick(uint64_t& state, const Entries& entries, uint64_t total, CountOf count_of)
+		{
+			uint64_t target = next(state) % total;
+			size_t i = 0;
+			while ( target >= count_of(entries[i]) )
+			{
+				target -= count_of(entries[i]);
+				i++;
+			}
+			return i;
+		}
+
+		FoodDistribution _distribution;
+		uint64_t _seed;
+		FoodCenti _range;
+		uint64_t _word_total = 0;
+		uint64_t _length_total = 0;
+};
+
+
+// Append value, in hundredths, with two decimals.
+void append_food_centi(std::string& output, FoodCenti value)
+{
+	if ( value < 0 )
+	{
+		output += '-';
+		value = -value;
+	}
+	char digits[24];
+	auto result = std::to_chars(digits, digits + sizeof(digits), value / 100);
+	output.append(digits, result.ptr);
+	output += '.';
+	output += char('0' + value % 100 / 10);
+	output += char('0' + value % 10);
+}
+
+// Write rows [first_row, first_row + rows) of generator's database to
+// output, preceded by food.csv's header line when header is true. Lines
+// end in '\n'. Output is buffered in blocks, so memory use does not grow
+// with rows. Returns false if output fails.
+bool write_food_dataset(std::ostream& output, const FoodGenerator& generator,
+	uint64_t first_row, uint64_t rows, bool header = true)
+{
+	const size_t block_size = 1 << 20;
+
+	std::string buffer;
+	buffer.reserve(block_size + 256);
+	if ( header )
+	{
+		buffer += "Item^Weight^Calorie\n";
+	}
+
+	std::string description;
+	FoodCenti weight, calories;
+	for ( uint64_t i = first_row; i < first_row + rows; i++ )
+	{
+		generator.row(i, description, weight, calories);
+		buffer += description;
+		buffer += '^';
+		append_food_centi(buffer, weight);
+		buffer += '^';
+		append_food_centi(buffer, calories);
+		buffer += '\n';
+
+		if ( buffer.size() >= block_size )
+		{
+			if ( ! output.write(buffer.data(), buffer.size()) )
+			{
+				return false;
+			}
+			buffer.clear();
+		}
+	}
+
+	return bool(output.write(buffer.data(), buffer.size()));
+}
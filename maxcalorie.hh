@@ -11,6 +11,7 @@
 
 
 #include <cassert>
+#include <charconv>
 #include <cmath>
 #include <fstream>
 #include <iostream>
@@ -21,6 +22,29 @@
 #include <vector>
 #include <algorithm>
 #include <iterator>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <thread>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <deque>
+#include <unordered_map>
+#include <type_traits>
+#include <cstddef>
+#include <new>
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MAXCALORIE_X86 1
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 // One food item available for purchase.
 class FoodItem
@@ -67,325 +91,4349 @@ class FoodItem
 typedef std::vector<std::shared_ptr<FoodItem>> FoodVector;
 
 
-// Load all the valid food items from the CSV database
-// Food items that are missing fields, or have invalid values, are skipped.
-// Returns nullptr on I/O error.
-std::unique_ptr<FoodVector> load_food_database(const std::string& path)
+// Read-only memory mapping of a whole file.
+// An empty file is a valid mapping with size() == 0 and data() == nullptr.
+class MappedFile
 {
-	std::unique_ptr<FoodVector> failure(nullptr);
-
-	std::ifstream f(path);
-	if (!f)
-	{
-		std::cout << "Failed to load food database; Cannot open file: " << path << std::endl;
-		return failure;
-	}
-
-	std::unique_ptr<FoodVector> result(new FoodVector);
-
-	size_t line_number = 0;
-	for (std::string line; std::getline(f, line); )
-	{
-		line_number++;
+	//
+	public:
 
-		// First line is a header row
-		if ( line_number == 1 )
+		//
+		explicit MappedFile(const std::string& path)
 		{
-			continue;
-		}
-
-		std::vector<std::string> fields;
-		std::stringstream ss(line);
+			int fd = ::open(path.c_str(), O_RDONLY);
+			if ( fd < 0 )
+			{
+				return;
+			}
 
-		for (std::string field; std::getline(ss, field, '^'); )
-		{
-			fields.push_back(field);
-		}
+			struct stat st;
+			if ( ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) )
+			{
+				_size = size_t(st.st_size);
+				if ( _size == 0 )
+				{
+					_open = true;
+				}
+				else
+				{
+					void* p = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+					if ( p != MAP_FAILED )
+					{
+						::madvise(p, _size, MADV_SEQUENTIAL);
+						_data = static_cast<const char*>(p);
+						_open = true;
+					}
+					else
+					{
+						_size = 0;
+					}
+				}
+			}
 
-		if (fields.size() != 3)
-		{
-			std::cout
-				<< "Failed to load food database: Invalid field count at line " << line_number << "; Want 3 but got " << fields.size() << std::endl
-				<< "Line: " << line << std::endl
-				;
-			return failure;
+			::close(fd);
 		}
 
-		std::string
-			descr_field = fields[0],
-			weight_ounces_field = fields[1],
-			calories_field = fields[2]
-			;
-
-		auto parse_dbl = [](const std::string& field, double& output)
+		~MappedFile()
 		{
-			std::stringstream ss(field);
-			if ( ! ss )
+			if ( _data )
 			{
-				return false;
+				::munmap(const_cast<char*>(_data), _size);
 			}
+		}
 
-			ss >> output;
-
-			return true;
-		};
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
 
-		std::string description(descr_field);
-		double weight_ounces, calories;
-		if (
-			parse_dbl(weight_ounces_field, weight_ounces)
-			&& parse_dbl(calories_field, calories)
-		)
-		{
-			result->push_back(
-				std::shared_ptr<FoodItem>(
-					new FoodItem(
-						description,
-						weight_ounces,
-						calories
-					)
-				)
-			);
-		}
-	}
+		//
+		bool is_open() const { return _open; }
+		const char* data() const { return _data; }
+		size_t size() const { return _size; }
+		const char* begin() const { return _data; }
+		const char* end() const { return _data + _size; }
 
-	f.close();
+	//
+	private:
 
-	return result;
-}
+		const char* _data = nullptr;
+		size_t _size = 0;
+		bool _open = false;
+};
 
 
-// Convenience function to compute the total weight and calories in
-// a FoodVector.
-// Provide the FoodVector as the first argument
-// The next two arguments will return the weight and calories back to
-// the caller.
-void sum_food_vector
+// Split one line into its '^'-delimited fields, in place.
+// This follows the std::getline(ss, field, '^') loop in load_food_database:
+// an empty line has no fields, and a trailing empty field is not counted.
+// Only the first max_fields views are stored, but the returned count is
+// the true number of fields.
+size_t split_food_line
 (
-	const FoodVector& foods,
-	double& total_weight,
-	double& total_calories
+	std::string_view line,
+	std::string_view* fields,
+	size_t max_fields
 )
 {
-	total_weight = total_calories = 0;
-	for (auto& food : foods)
+	size_t count = 0;
+	size_t start = 0;
+	while ( start < line.size() )
 	{
-		total_weight += food->weight();
-		total_calories += food->foodCalories();
+		size_t caret = line.find('^', start);
+		size_t stop = (caret == std::string_view::npos) ? line.size() : caret;
+
+		if ( count < max_fields )
+		{
+			fields[count] = line.substr(start, stop - start);
+		}
+		count++;
+
+		if ( caret == std::string_view::npos )
+		{
+			break;
+		}
+		start = caret + 1;
 	}
+	return count;
 }
 
 
-// Convenience function to print out each FoodItem in a FoodVector,
-// followed by the total weight and calories of it.
-void print_food_vector(const FoodVector& foods)
+// Parse a numeric field without allocating, independent of the locale.
+// Surrounding blanks (including the '\r' of CRLF files) are ignored.
+// Returns false, leaving output untouched, if the field is empty, is not
+// entirely a decimal number, or is not finite.
+bool parse_food_double(std::string_view field, double& output)
 {
-	std::cout << "*** food Vector ***" << std::endl;
-
-	if ( foods.size() == 0 )
+	auto is_blank = [](char c) { return c == ' ' || c == '\t' || c == '\r'; };
+	while ( ! field.empty() && is_blank(field.front()) )
 	{
-		std::cout << "[empty food list]" << std::endl;
+		field.remove_prefix(1);
 	}
-	else
+	while ( ! field.empty() && is_blank(field.back()) )
 	{
-		for (auto& food : foods)
+		field.remove_suffix(1);
+	}
+	if ( ! field.empty() && field.front() == '+' )
+	{
+		// from_chars takes its own '-' sign; a second sign is malformed.
+		field.remove_prefix(1);
+		if ( ! field.empty() && (field.front() == '-' || field.front() == '+') )
 		{
-			std::cout
-				<< "Ye olde " << food->description()
-				<< " ==> "
-				<< "Weight of " << food->weight() << " ounces"
-				<< "; calories = " << food->foodCalories()
-				<< std::endl
-				;
+			return false;
 		}
+	}
 
-		double total_weight, total_calories;
-		sum_food_vector(foods, total_weight, total_calories);
-		std::cout
-			<< "> Grand total weight: " << total_weight << " ounces" << std::endl
-			<< "> Grand total calories: " << total_calories
-			<< std::endl
-			;
+	double value;
+	const char* last = field.data() + field.size();
+	auto parsed = std::from_chars(field.data(), last, value, std::chars_format::general);
+	if ( parsed.ec != std::errc() || parsed.ptr != last || ! std::isfinite(value) )
+	{
+		return false;
 	}
+
+	output = value;
+	return true;
 }
 
 
-// Filter the vector source, i.e. create and return a new FoodVector
-// containing the subset of the food items in source that match given
-// criteria.
-// This is intended to:
-//	1) filter out food with zero or negative calories that are irrelevant to // our optimization
-//	2) limit the size of inputs to the exhaustive search algorithm since it // will probably be slow.
-//
-// Each food item that is included must have at minimum min_calories and
-// at most max_calories.
-//	(i.e., each included food item's calories must be between min_calories
-// and max_calories (inclusive).
-//
-// In addition, the the vector includes only the first total_size food items
-// that match these criteria.
-std::unique_ptr<FoodVector> filter_food_vector
-(
-	const FoodVector& source,
-	double min_calories,
-	double max_calories,
-	int total_size
-)
+// True when the parsed fields of a row can make a FoodItem; rows that fail
+// this are skipped by the loaders rather than tripping FoodItem's asserts.
+bool valid_food_row(std::string_view description, double weight_ounces)
 {
-	// Initialize the vector that will hold the filtered items.
-	std::unique_ptr<FoodVector> FilteredFoodVector(new FoodVector);
+	return ! description.empty() && weight_ounces > 0;
+}
 
-	// Loop to go through all the items in the food vector.
-	for(auto& food: source)
+
+// Delimiter scanning.
+// Each scan_food_delimiters_* function calls found(p) for every '^' and
+// '\n' in [begin, end), in increasing address order, reading the input in
+// one pass. The vector versions test a whole block per instruction and
+// walk the resulting bit mask; the tail shorter than a block is scanned
+// one character at a time.
+
+template <typename Found>
+void scan_food_delimiters_scalar(const char* begin, const char* end, Found&& found)
+{
+	for (const char* p = begin; p < end; p++)
 	{
-		// If the item satisfies the requirements of the minimum calories, maximum
-		// calories and within the size constraints, it will be added to our filtered
-		// vector.
-		if (food->foodCalories() >= min_calories && food->foodCalories() <= max_calories)
+		if ( *p == '^' || *p == '\n' )
 		{
-			if (int(FilteredFoodVector->size()) < total_size)
-			{
-				FilteredFoodVector->push_back(food);
-			}
-
-			// If we have filled up our vector, we will just break out the loop.
-			else
-			{
-				break;
-			}
+			found(p);
 		}
 	}
-
-	// Return the vector with the filtered items
-	return FilteredFoodVector;
 }
 
 
-// Compute the optimal set of food items with a greedy algorithm.
-// Specifically, among the food items that fit within a total_weight,
-// choose the foods whose calories-per-weight is greatest.
-// Repeat until no more food items can be chosen, either because we've
-// run out of food items, or run out of space.
-std::unique_ptr<FoodVector> greedy_max_calories
-(
-	const FoodVector& foods,
-	double total_weight
-)
+#ifdef MAXCALORIE_X86
+
+template <typename Found>
+void scan_food_delimiters_sse2(const char* begin, const char* end, Found&& found)
 {
-	// This is the structure for making the vector that has the cal/weight and the item
-	struct percentItem
+	const __m128i caret = _mm_set1_epi8('^');
+	const __m128i newline = _mm_set1_epi8('\n');
+
+	const char* p = begin;
+	for ( ; end - p >= 16; p += 16)
 	{
-		double percent;
-		FoodItem item;
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		unsigned mask = unsigned(_mm_movemask_epi8(_mm_or_si128(
+			_mm_cmpeq_epi8(block, caret),
+			_mm_cmpeq_epi8(block, newline)
+		)));
+		while ( mask )
+		{
+			found(p + __builtin_ctz(mask));
+			mask &= mask - 1;
+		}
+	}
+	scan_food_delimiters_scalar(p, end, found);
+}
 
-		percentItem(double p, FoodItem n) : percent(p), item(n) {}
 
-	};
+template <typename Found>
+__attribute__((target("avx2")))
+void scan_food_delimiters_avx2(const char* begin, const char* end, Found&& found)
+{
+	const __m256i caret = _mm256_set1_epi8('^');
+	const __m256i newline = _mm256_set1_epi8('\n');
 
-	// This is a comparator that will sort the percentItemVector based off the
-	// cal/weight from high to low.
-	struct sortPercentage
+	const char* p = begin;
+	for ( ; end - p >= 32; p += 32)
 	{
-		inline bool operator() (const percentItem firstSet, const percentItem secondSet)
+		__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+		unsigned mask = unsigned(_mm256_movemask_epi8(_mm256_or_si256(
+			_mm256_cmpeq_epi8(block, caret),
+			_mm256_cmpeq_epi8(block, newline)
+		)));
+		while ( mask )
 		{
-			return (firstSet.percent > secondSet.percent);
+			found(p + __builtin_ctz(mask));
+			mask &= mask - 1;
 		}
-	};
+	}
+	scan_food_delimiters_scalar(p, end, found);
+}
 
-	std::vector <percentItem> percentItemVector;
-	std::unique_ptr<FoodVector> GreedyFoodVector(new FoodVector);
+#endif
+
+
+// True when the running CPU can execute the AVX2 code paths; always false
+// off x86, where there are none.
+bool cpu_has_avx2()
+{
+#ifdef MAXCALORIE_X86
+	static const bool has_avx2 = __builtin_cpu_supports("avx2");
+	return has_avx2;
+#else
+	return false;
+#endif
+}
+
+// True when the running CPU can execute the AVX-512 code paths; always
+// false off x86.
+bool cpu_has_avx512f()
+{
+#ifdef MAXCALORIE_X86
+	static const bool has_avx512f = __builtin_cpu_supports("avx512f");
+	return has_avx512f;
+#else
+	return false;
+#endif
+}
 
-	// Initialize the current capacity, the temporary weight of the item with the
-	// capacity, and the cal/weight.
-	double capacity = 0;
-	double tempWeight = 0;
-	double percentage = 0;
 
-	// This for loop will add the percent of cal/weight with the item to a new vector
-	for(auto& food: foods)
+// Scan with the widest delimiter scanner the CPU supports: AVX2 when
+// available, SSE2 (part of the x86-64 baseline) otherwise, and the scalar
+// loop on other architectures.
+template <typename Found>
+void scan_food_delimiters(const char* begin, const char* end, Found&& found)
+{
+#ifdef MAXCALORIE_X86
+	if ( cpu_has_avx2() )
+	{
+		scan_food_delimiters_avx2(begin, end, found);
+	}
+	else
 	{
-			percentage = (food->foodCalories())/(food->weight());
-			percentItemVector.push_back(percentItem(percentage, *food));
+		scan_food_delimiters_sse2(begin, end, found);
 	}
+#else
+	scan_food_delimiters_scalar(begin, end, found);
+#endif
+}
+
 
-	// We will sort based off the percent of cal/weight for each item
-	std::sort(percentItemVector.begin(), percentItemVector.end(), sortPercentage());
+// Print the loaders' error for a line without exactly three fields.
+void print_food_field_count_error(size_t line_number, std::string_view line, size_t field_count)
+{
+	std::cout
+		<< "Failed to load food database: Invalid field count at line " << line_number << "; Want 3 but got " << field_count << std::endl
+		<< "Line: " << line << std::endl
+		;
+}
+
+
+// Why a CSV line did not become a food item.
+//	field_count: the line does not have exactly three fields.
+//	weight, calories: the field is not a number, or the weight is not
+//		positive.
+//	description: the description field is empty.
+enum class FoodRowError
+{
+	field_count,
+	weight,
+	calories,
+	description
+};
 
-	// This for loop will do the greedy algorithm
-	for(int i = 0; i < int(percentItemVector.size()); i++)
+
+// Human-readable text for a FoodRowError.
+const char* food_row_error_message(FoodRowError error)
+{
+	switch ( error )
 	{
-		// We find the temporary weight by adding the capacity with the item we are on.
-		// The if statement will make sure we are still within the weight limit.
-		tempWeight = capacity + percentItemVector[i].item.weight();
-		if (tempWeight <= total_weight)
-		{
-			// If we are within the weight limit, we will update the capacity and add
-			// the food item.
-			capacity += percentItemVector[i].item.weight();
-			GreedyFoodVector->push_back(std::shared_ptr<FoodItem>(new FoodItem(percentItemVector[i].item)));
-		}
+		case FoodRowError::field_count: return "invalid field count";
+		case FoodRowError::weight: return "invalid weight";
+		case FoodRowError::calories: return "invalid calories";
+		case FoodRowError::description: return "empty description";
 	}
-
-	// Return the vector with the items that satisfy the algorithm
-	return GreedyFoodVector;
+	return "unknown error";
 }
 
 
-// Compute the optimal set of food items with a exhaustive search algorithm.
-// Specifically, among all subsets of food items, return the subset
-// whose weight in ounces fits within the total_weight one can carry and
-// whose total calories is greatest.
-// To avoid overflow, the size of the food items vector must be less than 64.
-std::unique_ptr<FoodVector> exhaustive_max_calories
+// Parse the rows of a CSV buffer that holds whole lines, starting at line
+// first_line_number. Line 1 is the header row and is skipped.
+// Field boundaries come from a single scan_food_delimiters pass. A line
+// has as many fields as split_food_line would report for it, so a
+// trailing '^' adds no field and is not part of the calories.
+// Calls row(description, weight_ounces, calories) for every accepted row,
+// with the description as a view into the buffer.
+// On a line without exactly three fields, calls
+// bad_line(line_number, line, field_count); if that returns true the line
+// is skipped and parsing goes on, otherwise parsing stops and this returns
+// false. Rows before the bad line have already been passed to row.
+// A line with three fields whose values are invalid is skipped, after
+// calling rejected(line_number, line, error); the loaders pass a no-op
+// here, which compiles away.
+template <typename Row, typename BadLine, typename Rejected>
+bool parse_food_rows
 (
-	const FoodVector& foods,
-	double total_weight
+	const char* begin,
+	const char* end,
+	size_t first_line_number,
+	Row&& row,
+	BadLine&& bad_line,
+	Rejected&& rejected
 )
 {
-	// Initialize the Vectors that we will be using. The BestFoodVector will have
-	// the best combination and will be what is returned. The CandidateFoodVector
-	// will be what we use to keep checking what the best combination is.
-	std::unique_ptr<FoodVector> BestFoodVector(new FoodVector);
-	auto CandidateFoodVector(foods);
+	size_t line_number = first_line_number;
+	const char* line_start = begin;
+	const char* carets[3] = { nullptr, nullptr, nullptr };
+	const char* last_caret = nullptr;
+	size_t caret_count = 0;
+	bool ok = true;
 
-	// We will Initialize what we need for our loop and the weights and calories.
-	int bitSize = pow(2, foods.size());
-	double bestTotalCalries = 0;
-	double candTotalWeight = 0;
-	double candTotalCalories = 0;
-
-	for (int bit = 0; bit < bitSize; bit++)
+	auto finish_line = [&](const char* line_end)
 	{
-		// We will keep clearing this vector to get ready for the next candidate.
-		// We also set the candidate weight and calorie back to 0.
-		CandidateFoodVector.clear();
-		candTotalWeight = 0;
-		candTotalCalories = 0;
-		for (int j = 0; j < int(foods.size()); j++)
+		const char* last_field = last_caret ? last_caret + 1 : line_start;
+		size_t field_count = caret_count + 1 - (last_field == line_end ? 1 : 0);
+
+		if ( line_number == 1 )
+		{
+			// First line is a header row
+		}
+		else if ( field_count != 3 )
+		{
+			ok = bad_line(line_number, std::string_view(line_start, line_end - line_start), field_count);
+		}
+		else
 		{
-			if (((bit >> j) & 1) == 1)
+			// With three fields, a third caret can only be a trailing one.
+			const char* calories_end = caret_count > 2 ? carets[2] : line_end;
+			std::string_view
+				description(line_start, carets[0] - line_start),
+				weight_ounces_field(carets[0] + 1, carets[1] - carets[0] - 1),
+				calories_field(carets[1] + 1, calories_end - carets[1] - 1)
+				;
+
+			double weight_ounces, calories;
+			if (
+				parse_food_double(weight_ounces_field, weight_ounces)
+				&& parse_food_double(calories_field, calories)
+				&& valid_food_row(description, weight_ounces)
+			)
 			{
-				// Adding elements to our candidate vector.
-				CandidateFoodVector.push_back(foods[j]);
-				candTotalWeight += foods[j]->weight();
-				candTotalCalories += foods[j]->foodCalories();
+				row(description, weight_ounces, calories);
 			}
-			if (candTotalWeight <= total_weight)
+			else
 			{
-				if (candTotalCalories > bestTotalCalries)
+				std::string_view line(line_start, line_end - line_start);
+				if ( ! parse_food_double(weight_ounces_field, weight_ounces) || weight_ounces <= 0 )
 				{
-					// We will clear the best veector to get ready to update the best.
-					BestFoodVector->clear();
-					bestTotalCalries = candTotalCalories;
-					// Adding the elements from the candidate to the best vector.
-					for (auto& food : CandidateFoodVector)
-					{
-						BestFoodVector->push_back(food);
-					}
+					rejected(line_number, line, FoodRowError::weight);
+				}
+				else if ( ! parse_food_double(calories_field, calories) )
+				{
+					rejected(line_number, line, FoodRowError::calories);
+				}
+				else
+				{
+					rejected(line_number, line, FoodRowError::description);
 				}
 			}
 		}
-	}
-	// Return the vector with the items that satisfy the algorithm
+
+		line_number++;
+		caret_count = 0;
+		last_caret = nullptr;
+	};
+
+	// The scanner cannot be stopped early, so after a fatal bad line the
+	// remaining delimiters are ignored.
+	scan_food_delimiters(begin, end, [&](const char* p)
+	{
+		if ( ! ok )
+		{
+			return;
+		}
+		if ( *p == '^' )
+		{
+			if ( caret_count < 3 )
+			{
+				carets[caret_count] = p;
+			}
+			caret_count++;
+			last_caret = p;
+		}
+		else
+		{
+			finish_line(p);
+			line_start = p + 1;
+		}
+	});
+
+	// A last line without a trailing newline.
+	if ( ok && line_start < end )
+	{
+		finish_line(end);
+	}
+
+	return ok;
+}
+
+
+// As above, silently skipping rows with invalid values.
+template <typename Row, typename BadLine>
+bool parse_food_rows
+(
+	const char* begin,
+	const char* end,
+	size_t first_line_number,
+	Row&& row,
+	BadLine&& bad_line
+)
+{
+	return parse_food_rows(
+		begin, end, first_line_number, row, bad_line,
+		[](size_t, std::string_view, FoodRowError) { }
+	);
+}
+
+
+// As above, stopping at the first bad line after printing the same error
+// message as load_food_database.
+template <typename Row>
+bool parse_food_rows
+(
+	const char* begin,
+	const char* end,
+	size_t first_line_number,
+	Row&& row
+)
+{
+	return parse_food_rows(
+		begin, end, first_line_number, row,
+		[](size_t line_number, std::string_view line, size_t field_count)
+		{
+			print_food_field_count_error(line_number, line, field_count);
+			return false;
+		}
+	);
+}
+
+
+// Load the CSV database through a memory mapping of the whole file.
+// Lines and fields are string_views into the mapping, split by
+// parse_food_rows; the description is only copied into a FoodItem once its
+// row has been accepted. Accepts the same files, and reports the same
+// errors, as the stream loader.
+// Returns nullptr on I/O error.
+std::unique_ptr<FoodVector> load_food_database_mapped(const std::string& path)
+{
+	std::unique_ptr<FoodVector> failure(nullptr);
+
+	MappedFile file(path);
+	if ( ! file.is_open() )
+	{
+		std::cout << "Failed to load food database; Cannot open file: " << path << std::endl;
+		return failure;
+	}
+
+	std::unique_ptr<FoodVector> result(new FoodVector);
+
+	bool ok = parse_food_rows(
+		file.begin(), file.end(), 1,
+		[&](std::string_view description, double weight_ounces, double calories)
+		{
+			result->push_back(
+				std::make_shared<FoodItem>(
+					std::string(description),
+					weight_ounces,
+					calories
+				)
+			);
+		}
+	);
+	if ( ! ok )
+	{
+		return failure;
+	}
+
+	return result;
+}
+
+
+// Load the CSV database by parsing byte ranges of a memory mapping on
+// thread_count worker threads.
+// The body after the header row is cut into thread_count ranges whose
+// boundaries are moved forward to the next line start, so every line
+// belongs to exactly one range. Each worker fills its own FoodVector; the
+// vectors are concatenated in range order, so the result holds the same
+// rows in the same order as load_food_database. If any line has a bad
+// field count, the first such line in the file is reported, as the
+// serial loaders do, and nullptr is returned.
+// Returns nullptr on I/O error.
+std::unique_ptr<FoodVector> load_food_database_parallel
+(
+	const std::string& path,
+	unsigned thread_count = std::thread::hardware_concurrency()
+)
+{
+	std::unique_ptr<FoodVector> failure(nullptr);
+
+	MappedFile file(path);
+	if ( ! file.is_open() )
+	{
+		std::cout << "Failed to load food database; Cannot open file: " << path << std::endl;
+		return failure;
+	}
+
+	// The header row is left out of the ranges.
+	const char* body = static_cast<const char*>(std::memchr(file.begin(), '\n', file.size()));
+	body = body ? body + 1 : file.end();
+
+	size_t body_size = file.end() - body;
+	thread_count = std::max(1u, thread_count);
+	thread_count = unsigned(std::min<size_t>(thread_count, body_size / 4096 + 1));
+
+	// Worker i parses [bounds[i], bounds[i + 1]).
+	std::vector<const char*> bounds(thread_count + 1, file.end());
+	bounds[0] = body;
+	for (unsigned i = 1; i < thread_count; i++)
+	{
+		const char* guess = std::max(bounds[i - 1], body + body_size / thread_count * i);
+		const char* newline = static_cast<const char*>(std::memchr(guess, '\n', file.end() - guess));
+		bounds[i] = newline ? newline + 1 : file.end();
+	}
+
+	// What each worker found. The first bad line of a range is recorded
+	// with its line number counted from the start of the range.
+	struct ChunkResult
+	{
+		FoodVector foods;
+		bool ok = true;
+		size_t bad_line_index = 0;
+		std::string_view bad_line;
+		size_t bad_field_count = 0;
+	};
+	std::vector<ChunkResult> chunks(thread_count);
+
+	auto parse_chunk = [&](unsigned i)
+	{
+		ChunkResult& chunk = chunks[i];
+		// Any first line number other than 1 parses the range as body rows.
+		const size_t first = 2;
+		chunk.ok = parse_food_rows(
+			bounds[i], bounds[i + 1], first,
+			[&](std::string_view description, double weight_ounces, double calories)
+			{
+				chunk.foods.push_back(
+					std::make_shared<FoodItem>(
+						std::string(description),
+						weight_ounces,
+						calories
+					)
+				);
+			},
+			[&](size_t line_number, std::string_view line, size_t field_count)
+			{
+				chunk.bad_line_index = line_number - first;
+				chunk.bad_line = line;
+				chunk.bad_field_count = field_count;
+				return false;
+			}
+		);
+	};
+
+	std::vector<std::thread> workers;
+	for (unsigned i = 1; i < thread_count; i++)
+	{
+		workers.emplace_back(parse_chunk, i);
+	}
+	parse_chunk(0);
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+
+	// Line 1 is the header; ranges before a failing one only cost a newline
+	// count on this error path.
+	size_t first_line_number = 2;
+	for (unsigned i = 0; i < thread_count; i++)
+	{
+		if ( ! chunks[i].ok )
+		{
+			print_food_field_count_error(
+				first_line_number + chunks[i].bad_line_index,
+				chunks[i].bad_line,
+				chunks[i].bad_field_count
+			);
+			return failure;
+		}
+		first_line_number += std::count(bounds[i], bounds[i + 1], '\n');
+	}
+
+	size_t total = 0;
+	for (auto& chunk : chunks)
+	{
+		total += chunk.foods.size();
+	}
+
+	std::unique_ptr<FoodVector> result(new FoodVector);
+	result->reserve(total);
+	for (auto& chunk : chunks)
+	{
+		std::move(chunk.foods.begin(), chunk.foods.end(), std::back_inserter(*result));
+	}
+
+	return result;
+}
+
+
+// How load_food_database reads the CSV file.
+//	stream: std::getline over an std::ifstream, one std::string per line.
+//	mapped: mmap the whole file and split fields in place, without copying
+//		anything until a row is accepted.
+//	parallel: the mapped loader run over byte ranges on one thread per
+//		hardware core.
+enum class FoodLoadMode
+{
+	stream,
+	mapped,
+	parallel
+};
+
+
+// Load all the valid food items from the CSV database
+// Food items that are missing fields, or have invalid values, are skipped.
+// Returns nullptr on I/O error.
+std::unique_ptr<FoodVector> load_food_database
+(
+	const std::string& path,
+	FoodLoadMode mode = FoodLoadMode::stream
+)
+{
+	if ( mode == FoodLoadMode::mapped )
+	{
+		return load_food_database_mapped(path);
+	}
+	if ( mode == FoodLoadMode::parallel )
+	{
+		return load_food_database_parallel(path);
+	}
+
+	std::unique_ptr<FoodVector> failure(nullptr);
+
+	std::ifstream f(path);
+	if (!f)
+	{
+		std::cout << "Failed to load food database; Cannot open file: " << path << std::endl;
+		return failure;
+	}
+
+	std::unique_ptr<FoodVector> result(new FoodVector);
+
+	size_t line_number = 0;
+	for (std::string line; std::getline(f, line); )
+	{
+		line_number++;
+
+		// First line is a header row
+		if ( line_number == 1 )
+		{
+			continue;
+		}
+
+		std::vector<std::string> fields;
+		std::stringstream ss(line);
+
+		for (std::string field; std::getline(ss, field, '^'); )
+		{
+			fields.push_back(field);
+		}
+
+		if (fields.size() != 3)
+		{
+			std::cout
+				<< "Failed to load food database: Invalid field count at line " << line_number << "; Want 3 but got " << fields.size() << std::endl
+				<< "Line: " << line << std::endl
+				;
+			return failure;
+		}
+
+		std::string
+			descr_field = fields[0],
+			weight_ounces_field = fields[1],
+			calories_field = fields[2]
+			;
+
+		std::string description(descr_field);
+		double weight_ounces, calories;
+		if (
+			parse_food_double(weight_ounces_field, weight_ounces)
+			&& parse_food_double(calories_field, calories)
+			&& valid_food_row(description, weight_ounces)
+		)
+		{
+			result->push_back(
+				std::shared_ptr<FoodItem>(
+					new FoodItem(
+						description,
+						weight_ounces,
+						calories
+					)
+				)
+			);
+		}
+	}
+
+	f.close();
+
+	return result;
+}
+
+
+// One problem found by the error-collecting loader.
+struct FoodLoadDiagnostic
+{
+	size_t line_number;
+	size_t byte_offset;
+	FoodRowError error;
+};
+
+
+// What the error-collecting loader did with a file.
+// diagnostics holds the first problems found, up to the loader's limit;
+// diagnostics_dropped counts the problems after that, which are still
+// included in rows_skipped and skipped_by_error.
+struct FoodLoadReport
+{
+	size_t rows_loaded = 0;
+	size_t rows_skipped = 0;
+	size_t skipped_by_error[4] = { 0, 0, 0, 0 };
+	std::vector<FoodLoadDiagnostic> diagnostics;
+	size_t diagnostics_dropped = 0;
+
+	// The loaders' limit unless the caller gives another.
+	static constexpr size_t default_max_diagnostics = 64;
+
+	// Count a skipped line, and record it unless max_diagnostics are
+	// recorded already.
+	void skip(size_t line_number, size_t byte_offset, FoodRowError error, size_t max_diagnostics)
+	{
+		rows_skipped++;
+		skipped_by_error[int(error)]++;
+		if ( diagnostics.size() < max_diagnostics )
+		{
+			diagnostics.push_back({ line_number, byte_offset, error });
+		}
+		else
+		{
+			diagnostics_dropped++;
+		}
+	}
+};
+
+
+// Load the CSV database, skipping bad lines instead of failing on them.
+// Lines with a bad field count are skipped just like rows with invalid
+// values, and every skipped line is counted in report; the first
+// max_diagnostics of them are recorded with their line number, byte
+// offset and reason. Good rows are returned in file order.
+// Returns nullptr only on I/O error.
+std::unique_ptr<FoodVector> load_food_database
+(
+	const std::string& path,
+	FoodLoadReport& report,
+	size_t max_diagnostics = FoodLoadReport::default_max_diagnostics
+)
+{
+	report = FoodLoadReport();
+
+	MappedFile file(path);
+	if ( ! file.is_open() )
+	{
+		std::cout << "Failed to load food database; Cannot open file: " << path << std::endl;
+		return nullptr;
+	}
+
+	auto record = [&](size_t line_number, std::string_view line, FoodRowError error)
+	{
+		report.skip(line_number, size_t(line.data() - file.begin()), error, max_diagnostics);
+	};
+
+	std::unique_ptr<FoodVector> result(new FoodVector);
+	parse_food_rows(
+		file.begin(), file.end(), 1,
+		[&](std::string_view description, double weight_ounces, double calories)
+		{
+			result->push_back(std::make_shared<FoodItem>(std::string(description), weight_ounces, calories));
+		},
+		[&](size_t line_number, std::string_view line, size_t)
+		{
+			record(line_number, line, FoodRowError::field_count);
+			return true;
+		},
+		record
+	);
+	report.rows_loaded = result->size();
+
+	return result;
+}
+
+
+// Print a summary of a FoodLoadReport, one line per recorded diagnostic.
+void print_food_load_report(const FoodLoadReport& report)
+{
+	std::cout
+		<< "Loaded " << report.rows_loaded << " food items; skipped " << report.rows_skipped << " lines" << std::endl;
+	for (int error = 0; error < 4; error++)
+	{
+		if ( report.skipped_by_error[error] )
+		{
+			std::cout
+				<< "  " << food_row_error_message(FoodRowError(error)) << ": "
+				<< report.skipped_by_error[error] << std::endl;
+		}
+	}
+	for (auto& diagnostic : report.diagnostics)
+	{
+		std::cout
+			<< "  line " << diagnostic.line_number
+			<< " (byte " << diagnostic.byte_offset << "): "
+			<< food_row_error_message(diagnostic.error) << std::endl;
+	}
+	if ( report.diagnostics_dropped )
+	{
+		std::cout << "  ... and " << report.diagnostics_dropped << " more" << std::endl;
+	}
+}
+
+
+// Bump allocator over large slabs.
+// allocate() hands out consecutive pieces of the current slab; nothing is
+// freed piecemeal. reset() makes every slab reusable at once, so a caller
+// that reuses one arena across calls stops calling malloc after the first.
+// Objects placed in the arena are not destroyed by it.
+class MonotonicArena
+{
+	//
+	public:
+
+		//
+		explicit MonotonicArena(size_t slab_size = size_t(1) << 20) : _slab_size(slab_size) {}
+
+		MonotonicArena(const MonotonicArena&) = delete;
+		MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+		// size bytes aligned to align, which must be a power of two no larger
+		// than alignof(std::max_align_t).
+		void* allocate(size_t size, size_t align = alignof(std::max_align_t))
+		{
+			assert(align <= alignof(std::max_align_t) && (align & (align - 1)) == 0);
+			while ( true )
+			{
+				if ( _current < _slabs.size() )
+				{
+					size_t start = (_used + align - 1) & ~(align - 1);
+					if ( start + size <= _slabs[_current].size )
+					{
+						_used = start + size;
+						return _slabs[_current].bytes.get() + start;
+					}
+					_current++;
+					_used = 0;
+					continue;
+				}
+
+				// Requests larger than a slab get a slab of their own.
+				size_t slab = std::max(_slab_size, size);
+				_slabs.push_back({ std::unique_ptr<char[]>(new char[slab]), slab });
+				_current = _slabs.size() - 1;
+				_used = 0;
+			}
+		}
+
+		// Make all slabs free for reuse. Everything allocated so far is
+		// invalidated.
+		void reset()
+		{
+			_current = 0;
+			_used = 0;
+		}
+
+		// Total bytes held in slabs.
+		size_t bytes_reserved() const
+		{
+			size_t total = 0;
+			for (auto& slab : _slabs)
+			{
+				total += slab.size;
+			}
+			return total;
+		}
+
+	//
+	private:
+
+		struct Slab
+		{
+			std::unique_ptr<char[]> bytes;
+			size_t size;
+		};
+
+		size_t _slab_size;
+		std::vector<Slab> _slabs;
+		size_t _current = 0;
+		size_t _used = 0;
+};
+
+
+// Standard allocator that takes memory from a MonotonicArena, e.g. for
+// solver scratch vectors. deallocate does nothing; the memory comes back
+// when the arena is reset.
+template <typename T>
+class ArenaAllocator
+{
+	//
+	public:
+
+		typedef T value_type;
+
+		//
+		explicit ArenaAllocator(MonotonicArena& arena) : _arena(&arena) {}
+
+		template <typename U>
+		ArenaAllocator(const ArenaAllocator<U>& other) : _arena(other.arena()) {}
+
+		//
+		T* allocate(size_t n) { return static_cast<T*>(_arena->allocate(n * sizeof(T), alignof(T))); }
+		void deallocate(T*, size_t) {}
+
+		MonotonicArena* arena() const { return _arena; }
+
+		template <typename U>
+		bool operator==(const ArenaAllocator<U>& other) const { return _arena == other.arena(); }
+		template <typename U>
+		bool operator!=(const ArenaAllocator<U>& other) const { return _arena != other.arena(); }
+
+	//
+	private:
+
+		MonotonicArena* _arena;
+};
+
+
+// Dataset-owned storage for FoodItems.
+// Items are constructed back to back in MonotonicArena slabs instead of
+// one heap block each, and the pointers handed out are non-owning
+// aliasing shared_ptrs: they have no control block, so they cost no
+// allocation and copying them touches no reference count. All items are
+// destroyed, and their slabs freed, together with the arena, which must
+// therefore outlive every FoodVector that points into it. That includes
+// the results of the solvers and filters run on such a FoodVector: they
+// copy the same non-owning pointers, which keep nothing alive.
+// FoodItem keeps its description in a std::string, so a description too
+// long for the string's inline buffer still has its own heap block.
+class FoodArena
+{
+	//
+	public:
+
+		//
+		FoodArena() : _slabs(sizeof(FoodItem) * 4096) {}
+
+		FoodArena(const FoodArena&) = delete;
+		FoodArena& operator=(const FoodArena&) = delete;
+
+		~FoodArena()
+		{
+			for (FoodItem* item : _items)
+			{
+				item->~FoodItem();
+			}
+		}
+
+		// Construct a FoodItem in the arena.
+		std::shared_ptr<FoodItem> make_item(const std::string& description, double weight_ounces, double calories)
+		{
+			void* place = _slabs.allocate(sizeof(FoodItem), alignof(FoodItem));
+			FoodItem* item = new (place) FoodItem(description, weight_ounces, calories);
+			_items.push_back(item);
+			return std::shared_ptr<FoodItem>(std::shared_ptr<void>(), item);
+		}
+
+		//
+		size_t size() const { return _items.size(); }
+		size_t bytes_reserved() const { return _slabs.bytes_reserved(); }
+
+	//
+	private:
+
+		MonotonicArena _slabs;
+		std::vector<FoodItem*> _items;
+};
+
+
+// Load the CSV database with the mapped loader, constructing the items in
+// arena. The returned FoodVector holds non-owning pointers, so arena must
+// outlive it.
+// Returns nullptr on I/O error.
+std::unique_ptr<FoodVector> load_food_database(const std::string& path, FoodArena& arena)
+{
+	MappedFile file(path);
+	if ( ! file.is_open() )
+	{
+		std::cout << "Failed to load food database; Cannot open file: " << path << std::endl;
+		return nullptr;
+	}
+
+	std::unique_ptr<FoodVector> result(new FoodVector);
+	std::string description;
+	bool ok = parse_food_rows(
+		file.begin(), file.end(), 1,
+		[&](std::string_view description_field, double weight_ounces, double calories)
+		{
+			description.assign(description_field);
+			result->push_back(arena.make_item(description, weight_ounces, calories));
+		}
+	);
+	if ( ! ok )
+	{
+		return nullptr;
+	}
+	return result;
+}
+
+
+// One item's place in greedy order: its calories-per-weight and its
+// index in the input. Sorting these moves 16 bytes per item and no
+// strings.
+struct DensityKey
+{
+	double percent;
+	uint32_t index;
+};
+
+
+// True when a comes before b in greedy order: greater calories-per-weight
+// first, and equal calories-per-weight in input order.
+inline bool density_key_before(const DensityKey& a, const DensityKey& b)
+{
+	return a.percent > b.percent || (a.percent == b.percent && a.index < b.index);
+}
+
+
+// percent as an unsigned integer that is smaller exactly when percent is
+// greater, with -0.0 and 0.0 equal, so that sorting these integers in
+// increasing order sorts by decreasing calories-per-weight.
+inline uint64_t density_radix_key(double percent)
+{
+	percent += 0.0;
+	uint64_t bits;
+	std::memcpy(&bits, &percent, sizeof(bits));
+	bits = (bits >> 63) ? ~bits : bits | (uint64_t(1) << 63);
+	return ~bits;
+}
+
+
+// Sort keys, which must be in index order, as by density_key_before with
+// a least-significant-digit radix sort on density_radix_key: six stable
+// counting passes of 11 bits, after one pass that counts every digit.
+// Passes where all keys share a digit are skipped. Being stable, the sort
+// keeps equal calories-per-weight in index order.
+template <typename Keys>
+void radix_sort_density_keys(Keys& keys)
+{
+	const unsigned digit_bits = 11, passes = 6;
+	const size_t buckets = size_t(1) << digit_bits;
+	const size_t n = keys.size();
+	if ( n < 2 )
+	{
+		return;
+	}
+
+	std::vector<size_t> counts(passes * buckets, 0);
+	for (const auto& key : keys)
+	{
+		uint64_t radix = density_radix_key(key.percent);
+		for (unsigned pass = 0; pass < passes; pass++)
+		{
+			counts[pass * buckets + ((radix >> (pass * digit_bits)) & (buckets - 1))]++;
+		}
+	}
+
+	Keys scratch(n, keys.get_allocator());
+	auto* source = keys.data();
+	auto* target = scratch.data();
+	for (unsigned pass = 0; pass < passes; pass++)
+	{
+		size_t* count = &counts[pass * buckets];
+		unsigned shift = pass * digit_bits;
+		if ( count[(density_radix_key(source[0].percent) >> shift) & (buckets - 1)] == n )
+		{
+			continue;
+		}
+
+		size_t offset = 0;
+		for (size_t digit = 0; digit < buckets; digit++)
+		{
+			size_t c = count[digit];
+			count[digit] = offset;
+			offset += c;
+		}
+		for (size_t i = 0; i < n; i++)
+		{
+			target[count[(density_radix_key(source[i].percent) >> shift) & (buckets - 1)]++] = source[i];
+		}
+		std::swap(source, target);
+	}
+
+	if ( source != keys.data() )
+	{
+		std::copy(source, source + n, keys.data());
+	}
+}
+
+
+// Below this many keys, sort_density_keys uses std::sort.
+constexpr size_t DENSITY_RADIX_THRESHOLD = 512;
+
+// Sort keys, built in index order, into greedy order.
+template <typename Keys>
+void sort_density_keys(Keys& keys)
+{
+	if ( keys.size() >= DENSITY_RADIX_THRESHOLD )
+	{
+		radix_sort_density_keys(keys);
+	}
+	else
+	{
+		std::sort(keys.begin(), keys.end(), density_key_before);
+	}
+}
+
+
+// A dataset's items in greedy order, with running totals, built once and
+// reused by every greedy call on that dataset instead of sorting again.
+// order lists item indices by decreasing calories-per-weight, equal
+// calories-per-weight in input order. prefix_weight[k] and
+// prefix_calories[k] are the totals of the first k items of order, summed
+// in that order, so they match greedy's own running totals exactly.
+template <typename Number>
+struct BasicDensityIndex
+{
+	std::vector<uint32_t> order;
+	std::vector<Number> prefix_weight;
+	std::vector<Number> prefix_calories;
+
+	//
+	size_t size() const { return order.size(); }
+
+	// The number of leading items of order whose total weight is at most
+	// total_weight, i.e. the items greedy takes before it first has to
+	// skip one. O(log n).
+	size_t critical_position(Number total_weight) const
+	{
+		return size_t(std::upper_bound(prefix_weight.begin() + 1, prefix_weight.end(), total_weight) - prefix_weight.begin()) - 1;
+	}
+
+	// Fill prefix_weight and prefix_calories from order.
+	template <typename WeightOf, typename CaloriesOf>
+	void sum_prefixes(WeightOf&& weight_of, CaloriesOf&& calories_of)
+	{
+		prefix_weight.assign(order.size() + 1, 0);
+		prefix_calories.assign(order.size() + 1, 0);
+		for (size_t k = 0; k < order.size(); k++)
+		{
+			prefix_weight[k + 1] = prefix_weight[k] + weight_of(order[k]);
+			prefix_calories[k + 1] = prefix_calories[k] + calories_of(order[k]);
+		}
+	}
+};
+
+
+// Density index over doubles, as used with FoodVector and FoodTable.
+typedef BasicDensityIndex<double> DensityIndex;
+
+
+// Build the density index of foods. It stays valid until foods changes.
+DensityIndex build_density_index(const FoodVector& foods)
+{
+	assert(foods.size() <= UINT32_MAX);
+
+	std::vector<DensityKey> keys(foods.size());
+	for (size_t i = 0; i < foods.size(); i++)
+	{
+		keys[i] = { foods[i]->foodCalories() / foods[i]->weight(), uint32_t(i) };
+	}
+	sort_density_keys(keys);
+
+	DensityIndex index;
+	index.order.resize(keys.size());
+	for (size_t k = 0; k < keys.size(); k++)
+	{
+		index.order[k] = keys[k].index;
+	}
+	index.sum_prefixes(
+		[&](uint32_t i) { return foods[i]->weight(); },
+		[&](uint32_t i) { return foods[i]->foodCalories(); }
+	);
+	return index;
+}
+
+
+// Binary snapshot of a loaded food database.
+// A snapshot file is a FoodSnapshotHeader followed by 8-byte aligned
+// sections, all in host byte order:
+//	weights:		double[row_count]
+//	calories:		double[row_count]
+//	description offsets:	uint64_t[row_count + 1], into the blob
+//	descriptions:		the description bytes, back to back
+// and, when saved with one, the dataset's DensityIndex:
+//	density order:		uint32_t[row_count]
+//	density prefix weight:	double[row_count + 1]
+//	density prefix calories:	double[row_count + 1]
+// whose offsets are 0 when there is no index.
+// The header records the size and modification time of the CSV file the
+// snapshot was made from, and a checksum of the header (with the checksum
+// field zeroed) and everything after it, so a stale or damaged snapshot is
+// never used. open() also checks that every section and description lies
+// inside the file, so even a header that matches its checksum cannot make
+// a reader leave the mapping.
+struct FoodSnapshotHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t header_size;
+	uint64_t file_size;
+	uint64_t checksum;
+	uint64_t source_size;
+	int64_t source_mtime;
+	uint64_t row_count;
+	uint64_t weights_offset;
+	uint64_t calories_offset;
+	uint64_t description_offsets_offset;
+	uint64_t descriptions_offset;
+	uint64_t descriptions_size;
+	uint64_t density_order_offset;
+	uint64_t density_prefix_weight_offset;
+	uint64_t density_prefix_calories_offset;
+};
+
+const char FOOD_SNAPSHOT_MAGIC[8] = { 'F', 'O', 'O', 'D', 'S', 'N', 'A', 'P' };
+const uint32_t FOOD_SNAPSHOT_VERSION = 3;
+
+
+// 64-bit checksum of a byte range, mixed one 8-byte word at a time.
+uint64_t food_snapshot_checksum(const char* data, size_t size)
+{
+	uint64_t hash = 0x9e3779b97f4a7c15ull ^ size;
+	auto mix = [&hash](uint64_t word)
+	{
+		hash ^= word;
+		hash *= 0xff51afd7ed558ccdull;
+		hash ^= hash >> 32;
+	};
+
+	size_t i = 0;
+	for ( ; i + 8 <= size; i += 8)
+	{
+		uint64_t word;
+		std::memcpy(&word, data + i, 8);
+		mix(word);
+	}
+	uint64_t tail = 0;
+	std::memcpy(&tail, data + i, size - i);
+	mix(tail);
+
+	return hash;
+}
+
+
+// The checksum stored in a snapshot: of the header, with its checksum
+// field zeroed, and of the body that follows it.
+uint64_t food_snapshot_image_checksum(const FoodSnapshotHeader& header, const char* body, size_t body_size)
+{
+	FoodSnapshotHeader unsummed = header;
+	unsummed.checksum = 0;
+	return food_snapshot_checksum(reinterpret_cast<const char*>(&unsummed), sizeof(unsummed))
+		^ (food_snapshot_checksum(body, body_size) * 31);
+}
+
+
+// Size and modification time of the file at path, as stored in a
+// snapshot header. Returns false if the file cannot be examined.
+bool food_source_stamp(const std::string& path, uint64_t& size, int64_t& mtime)
+{
+	std::error_code error;
+	auto file_size = std::filesystem::file_size(path, error);
+	if ( error )
+	{
+		return false;
+	}
+	auto write_time = std::filesystem::last_write_time(path, error);
+	if ( error )
+	{
+		return false;
+	}
+	size = file_size;
+	mtime = int64_t(write_time.time_since_epoch().count());
+	return true;
+}
+
+
+// Write a snapshot of foods, stamped with the current state of the CSV
+// file at source_path, to snapshot_path. With with_density_index, foods'
+// DensityIndex is built and stored too.
+// The snapshot is written to a temporary file and renamed into place, so a
+// reader never sees a partial snapshot.
+// Returns false on I/O error.
+bool save_food_snapshot
+(
+	const FoodVector& foods,
+	const std::string& snapshot_path,
+	const std::string& source_path,
+	bool with_density_index = true
+)
+{
+	FoodSnapshotHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, FOOD_SNAPSHOT_MAGIC, sizeof(header.magic));
+	header.version = FOOD_SNAPSHOT_VERSION;
+	header.header_size = sizeof(FoodSnapshotHeader);
+	if ( ! food_source_stamp(source_path, header.source_size, header.source_mtime) )
+	{
+		return false;
+	}
+
+	auto align = [](uint64_t offset) { return (offset + 7) & ~uint64_t(7); };
+
+	size_t n = foods.size();
+	header.row_count = n;
+	header.weights_offset = align(sizeof(FoodSnapshotHeader));
+	header.calories_offset = header.weights_offset + n * sizeof(double);
+	header.description_offsets_offset = header.calories_offset + n * sizeof(double);
+	header.descriptions_offset = header.description_offsets_offset + (n + 1) * sizeof(uint64_t);
+	for (auto& food : foods)
+	{
+		header.descriptions_size += food->description().size();
+	}
+	header.file_size = header.descriptions_offset + header.descriptions_size;
+
+	DensityIndex index;
+	if ( with_density_index )
+	{
+		index = build_density_index(foods);
+		header.density_order_offset = align(header.file_size);
+		header.density_prefix_weight_offset = align(header.density_order_offset + n * sizeof(uint32_t));
+		header.density_prefix_calories_offset = header.density_prefix_weight_offset + (n + 1) * sizeof(double);
+		header.file_size = header.density_prefix_calories_offset + (n + 1) * sizeof(double);
+	}
+
+	std::string image(header.file_size, '\0');
+	char* base = &image[0];
+	uint64_t description_offset = 0;
+	for (size_t i = 0; i < n; i++)
+	{
+		const FoodItem& food = *foods[i];
+		double weight = food.weight(), calories = food.foodCalories();
+		std::memcpy(base + header.weights_offset + i * sizeof(double), &weight, sizeof(double));
+		std::memcpy(base + header.calories_offset + i * sizeof(double), &calories, sizeof(double));
+		std::memcpy(base + header.description_offsets_offset + i * sizeof(uint64_t), &description_offset, sizeof(uint64_t));
+		std::memcpy(base + header.descriptions_offset + description_offset, food.description().data(), food.description().size());
+		description_offset += food.description().size();
+	}
+	std::memcpy(base + header.description_offsets_offset + n * sizeof(uint64_t), &description_offset, sizeof(uint64_t));
+	if ( with_density_index )
+	{
+		std::memcpy(base + header.density_order_offset, index.order.data(), n * sizeof(uint32_t));
+		std::memcpy(base + header.density_prefix_weight_offset, index.prefix_weight.data(), (n + 1) * sizeof(double));
+		std::memcpy(base + header.density_prefix_calories_offset, index.prefix_calories.data(), (n + 1) * sizeof(double));
+	}
+
+	header.checksum = food_snapshot_image_checksum(header, base + sizeof(FoodSnapshotHeader), image.size() - sizeof(FoodSnapshotHeader));
+	std::memcpy(base, &header, sizeof(header));
+
+	std::string temporary_path = snapshot_path + ".tmp";
+	{
+		std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+		if ( ! out.write(image.data(), image.size()) )
+		{
+			std::remove(temporary_path.c_str());
+			return false;
+		}
+	}
+	return std::rename(temporary_path.c_str(), snapshot_path.c_str()) == 0;
+}
+
+
+// A read-only view of a snapshot file, opened with one mmap and no
+// parsing. Columns point straight into the mapping.
+class FoodSnapshot
+{
+	//
+	public:
+
+		// Open the snapshot at snapshot_path.
+		// When source_path is non-empty, the snapshot must have been made
+		// from a file with that path's current size and modification time.
+		// Returns nullptr if the snapshot is missing, stale, of another
+		// version, fails its checksum, or has a section or description
+		// offset outside the file.
+		static std::unique_ptr<FoodSnapshot> open
+		(
+			const std::string& snapshot_path,
+			const std::string& source_path
+		)
+		{
+			std::unique_ptr<FoodSnapshot> snapshot(new FoodSnapshot(snapshot_path));
+			const MappedFile& file = snapshot->_file;
+			if ( ! file.is_open() || file.size() < sizeof(FoodSnapshotHeader) )
+			{
+				return nullptr;
+			}
+
+			const FoodSnapshotHeader& header = snapshot->header();
+			if (
+				std::memcmp(header.magic, FOOD_SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+				|| header.version != FOOD_SNAPSHOT_VERSION
+				|| header.header_size != sizeof(FoodSnapshotHeader)
+				|| header.file_size != file.size()
+				|| header.row_count >= file.size()
+				|| ! section_fits(header.weights_offset, header.row_count, sizeof(double), file.size())
+				|| ! section_fits(header.calories_offset, header.row_count, sizeof(double), file.size())
+				|| ! section_fits(header.description_offsets_offset, header.row_count + 1, sizeof(uint64_t), file.size())
+				|| ! section_fits(header.descriptions_offset, header.descriptions_size, 1, file.size())
+			)
+			{
+				return nullptr;
+			}
+
+			// Without a density index the descriptions end the file; with
+			// one, its three sections follow them and end the file.
+			uint64_t descriptions_end = header.descriptions_offset + header.descriptions_size;
+			if ( header.density_order_offset == 0 )
+			{
+				if (
+					descriptions_end != file.size()
+					|| header.density_prefix_weight_offset != 0
+					|| header.density_prefix_calories_offset != 0
+				)
+				{
+					return nullptr;
+				}
+			}
+			else if (
+				header.density_order_offset < descriptions_end
+				|| ! section_fits(header.density_order_offset, header.row_count, sizeof(uint32_t), file.size())
+				|| header.density_prefix_weight_offset < header.density_order_offset + header.row_count * sizeof(uint32_t)
+				|| ! section_fits(header.density_prefix_weight_offset, header.row_count + 1, sizeof(double), file.size())
+				|| header.density_prefix_calories_offset < header.density_prefix_weight_offset + (header.row_count + 1) * sizeof(double)
+				|| ! section_fits(header.density_prefix_calories_offset, header.row_count + 1, sizeof(double), file.size())
+				|| header.density_prefix_calories_offset + (header.row_count + 1) * sizeof(double) != file.size()
+			)
+			{
+				return nullptr;
+			}
+
+			if ( ! source_path.empty() )
+			{
+				uint64_t source_size;
+				int64_t source_mtime;
+				if (
+					! food_source_stamp(source_path, source_size, source_mtime)
+					|| source_size != header.source_size
+					|| source_mtime != header.source_mtime
+				)
+				{
+					return nullptr;
+				}
+			}
+
+			if ( food_snapshot_image_checksum(header, file.data() + sizeof(FoodSnapshotHeader), file.size() - sizeof(FoodSnapshotHeader)) != header.checksum )
+			{
+				return nullptr;
+			}
+
+			// Every description lies inside the descriptions section.
+			const uint64_t* offsets = snapshot->column<uint64_t>(header.description_offsets_offset);
+			if ( offsets[0] != 0 || offsets[header.row_count] != header.descriptions_size )
+			{
+				return nullptr;
+			}
+			for (uint64_t i = 0; i < header.row_count; i++)
+			{
+				if ( offsets[i + 1] < offsets[i] )
+				{
+					return nullptr;
+				}
+			}
+
+			// Every density order entry names a row.
+			if ( header.density_order_offset != 0 )
+			{
+				const uint32_t* order = snapshot->column<uint32_t>(header.density_order_offset);
+				for (uint64_t k = 0; k < header.row_count; k++)
+				{
+					if ( order[k] >= header.row_count )
+					{
+						return nullptr;
+					}
+				}
+			}
+
+			return snapshot;
+		}
+
+		//
+		size_t size() const { return header().row_count; }
+		const double* weights() const { return column<double>(header().weights_offset); }
+		const double* calories() const { return column<double>(header().calories_offset); }
+		double weight(size_t i) const { return weights()[i]; }
+		double foodCalories(size_t i) const { return calories()[i]; }
+		std::string_view description(size_t i) const
+		{
+			const uint64_t* offsets = column<uint64_t>(header().description_offsets_offset);
+			return std::string_view(
+				_file.data() + header().descriptions_offset + offsets[i],
+				offsets[i + 1] - offsets[i]
+			);
+		}
+
+		// The stored density index, for the rows in this snapshot.
+		bool has_density_index() const { return header().density_order_offset != 0; }
+		const uint32_t* density_order() const { return column<uint32_t>(header().density_order_offset); }
+		const double* density_prefix_weight() const { return column<double>(header().density_prefix_weight_offset); }
+		const double* density_prefix_calories() const { return column<double>(header().density_prefix_calories_offset); }
+
+		// Copy the stored density index. Requires has_density_index().
+		DensityIndex density_index() const
+		{
+			assert(has_density_index());
+			DensityIndex index;
+			index.order.assign(density_order(), density_order() + size());
+			index.prefix_weight.assign(density_prefix_weight(), density_prefix_weight() + size() + 1);
+			index.prefix_calories.assign(density_prefix_calories(), density_prefix_calories() + size() + 1);
+			return index;
+		}
+
+		// Copy the snapshot's rows into a new FoodVector.
+		std::unique_ptr<FoodVector> to_food_vector() const
+		{
+			std::unique_ptr<FoodVector> result(new FoodVector);
+			result->reserve(size());
+			for (size_t i = 0; i < size(); i++)
+			{
+				result->push_back(std::make_shared<FoodItem>(std::string(description(i)), weight(i), foodCalories(i)));
+			}
+			return result;
+		}
+
+	//
+	private:
+
+		explicit FoodSnapshot(const std::string& path) : _file(path) {}
+
+		// True when count elements of element_size bytes, starting at
+		// offset, lie after the header and inside a file of file_size
+		// bytes, with offset aligned for the element. Does not overflow.
+		static bool section_fits(uint64_t offset, uint64_t count, uint64_t element_size, uint64_t file_size)
+		{
+			return offset >= sizeof(FoodSnapshotHeader)
+				&& offset <= file_size
+				&& offset % element_size == 0
+				&& count <= (file_size - offset) / element_size;
+		}
+
+		const FoodSnapshotHeader& header() const
+		{
+			return *reinterpret_cast<const FoodSnapshotHeader*>(_file.data());
+		}
+
+		template <typename T>
+		const T* column(uint64_t offset) const
+		{
+			return reinterpret_cast<const T*>(_file.data() + offset);
+		}
+
+		MappedFile _file;
+};
+
+
+// Load the food database at csv_path through the snapshot at
+// snapshot_path.
+// A current snapshot is used as is. Otherwise the CSV file is loaded with
+// the mapped loader and a fresh snapshot is written for the next caller; a
+// failure to write it is not an error.
+// Returns nullptr on I/O error.
+std::unique_ptr<FoodVector> load_food_database_cached
+(
+	const std::string& csv_path,
+	const std::string& snapshot_path
+)
+{
+	auto snapshot = FoodSnapshot::open(snapshot_path, csv_path);
+	if ( snapshot )
+	{
+		return snapshot->to_food_vector();
+	}
+
+	auto foods = load_food_database_mapped(csv_path);
+	if ( foods )
+	{
+		save_food_snapshot(*foods, snapshot_path, csv_path);
+	}
+	return foods;
+}
+
+
+// Visit the valid food items of the CSV database at path one row at a
+// time, in file order, without building a FoodVector.
+// Calls visit(description, weight_ounces, calories) for every row that
+// load_food_database would keep; the description view is only valid
+// during the call. visit returns true to go on, or false to stop early.
+// The file is mapped and parsed in blocks of whole lines, so stopping
+// early skips the rest of the file and memory use does not grow with its
+// size.
+// Returns false on I/O error or a bad field count, after printing the
+// same message as load_food_database; stopping early is not an error.
+template <typename Visit>
+bool visit_food_database(const std::string& path, Visit&& visit)
+{
+	MappedFile file(path);
+	if ( ! file.is_open() )
+	{
+		std::cout << "Failed to load food database; Cannot open file: " << path << std::endl;
+		return false;
+	}
+
+	const size_t block_size = size_t(1) << 20;
+
+	bool stopped = false;
+	size_t line_number = 1;
+	const char* block = file.begin();
+	while ( block < file.end() && ! stopped )
+	{
+		const char* block_end = file.end();
+		if ( size_t(file.end() - block) > block_size )
+		{
+			const char* newline = static_cast<const char*>(std::memchr(block + block_size, '\n', file.end() - block - block_size));
+			block_end = newline ? newline + 1 : file.end();
+		}
+
+		bool ok = parse_food_rows(
+			block, block_end, line_number,
+			[&](std::string_view description, double weight_ounces, double calories)
+			{
+				if ( ! stopped && ! visit(description, weight_ounces, calories) )
+				{
+					stopped = true;
+				}
+			}
+		);
+		if ( ! ok )
+		{
+			return false;
+		}
+
+		line_number += std::count(block, block_end, '\n');
+		block = block_end;
+	}
+
+	return true;
+}
+
+
+// What IncrementalFoodDatabase::refresh did.
+//	unchanged: the file has not grown; the dataset is as it was.
+//	appended: only the newly appended bytes were parsed.
+//	reloaded: the file was truncated or rewritten (or this was the first
+//		load), so it was parsed from the start.
+//	failed: the file could not be read; the dataset is as it was.
+enum class FoodRefresh
+{
+	unchanged,
+	appended,
+	reloaded,
+	failed
+};
+
+
+// A food database that follows an append-only CSV file.
+// Each refresh parses only the bytes appended since the last one, so its
+// cost scales with the appended data rather than the file size. The byte
+// offset and line number just after the last complete line are kept; the
+// rows of an unterminated last line are kept as well, like
+// load_food_database does, but are parsed again once the line grows. An
+// unterminated last line that does not have three fields yet is treated
+// as still being written and is left for a later refresh.
+// Bad complete lines are skipped and recorded in report(), as the
+// error-collecting load_food_database does, so one bad line never stops
+// later rows from being picked up.
+// Truncation or rewriting is noticed from a change of inode, a file
+// shorter than the parsed part, or a change in the first or last 4 KiB of
+// the parsed part, and falls back to a full reload.
+class IncrementalFoodDatabase
+{
+	//
+	public:
+
+		//
+		explicit IncrementalFoodDatabase(const std::string& path) : _path(path) {}
+
+		// Bring the dataset up to date with the file.
+		FoodRefresh refresh()
+		{
+			struct stat st;
+			if ( ::stat(_path.c_str(), &st) != 0 )
+			{
+				std::cout << "Failed to load food database; Cannot open file: " << _path << std::endl;
+				return FoodRefresh::failed;
+			}
+
+			bool same_file = _loaded && st.st_dev == _device && st.st_ino == _inode && size_t(st.st_size) >= _offset;
+			if ( same_file && size_t(st.st_size) == _size && st.st_mtime == _mtime )
+			{
+				return FoodRefresh::unchanged;
+			}
+
+			MappedFile file(_path);
+			if ( ! file.is_open() )
+			{
+				std::cout << "Failed to load food database; Cannot open file: " << _path << std::endl;
+				return FoodRefresh::failed;
+			}
+
+			if ( same_file && fingerprint(file) != _fingerprint )
+			{
+				same_file = false;
+			}
+
+			if ( same_file )
+			{
+				if ( file.size() == _size )
+				{
+					_mtime = st.st_mtime;
+					return FoodRefresh::unchanged;
+				}
+				parse_from(file, _offset, _line_number);
+				_mtime = st.st_mtime;
+				return FoodRefresh::appended;
+			}
+
+			IncrementalFoodDatabase fresh(_path);
+			fresh.parse_from(file, 0, 1);
+			fresh._device = st.st_dev;
+			fresh._inode = st.st_ino;
+			fresh._mtime = st.st_mtime;
+			fresh._loaded = true;
+			*this = std::move(fresh);
+			return FoodRefresh::reloaded;
+		}
+
+		// The rows loaded so far, in file order.
+		const FoodVector& foods() const { return _foods; }
+
+		// Offset just after the last complete line parsed.
+		size_t byte_offset() const { return _offset; }
+
+		// The rows loaded and the lines skipped since the last full load,
+		// with the first FoodLoadReport::default_max_diagnostics skipped
+		// lines recorded.
+		const FoodLoadReport& report() const { return _report; }
+
+	//
+	private:
+
+		// Parse file from offset, which starts line line_number, dropping
+		// the rows of the previous unterminated last line first. Bad
+		// complete lines are skipped and recorded in _report.
+		void parse_from(const MappedFile& file, size_t offset, size_t line_number)
+		{
+			size_t kept = _foods.size() - _pending_rows;
+
+			const char* start = file.begin() + offset;
+			const char* last_newline = start;
+			for (const char* p = file.end(); p > start; p--)
+			{
+				if ( p[-1] == '\n' )
+				{
+					last_newline = p;
+					break;
+				}
+			}
+
+			FoodVector added;
+			auto push = [&](std::string_view description, double weight_ounces, double calories)
+			{
+				added.push_back(std::make_shared<FoodItem>(std::string(description), weight_ounces, calories));
+			};
+
+			auto record = [&](size_t bad_line_number, std::string_view line, FoodRowError error)
+			{
+				_report.skip(bad_line_number, size_t(line.data() - file.begin()), error, FoodLoadReport::default_max_diagnostics);
+			};
+			parse_food_rows(
+				start, last_newline, line_number, push,
+				[&](size_t bad_line_number, std::string_view line, size_t)
+				{
+					record(bad_line_number, line, FoodRowError::field_count);
+					return true;
+				},
+				record
+			);
+			size_t complete_rows = added.size();
+			size_t next_line_number = line_number + std::count(start, last_newline, '\n');
+
+			bool partial_ok = parse_food_rows(
+				last_newline, file.end(), next_line_number, push,
+				[](size_t, std::string_view, size_t) { return false; }
+			);
+			if ( ! partial_ok )
+			{
+				added.resize(complete_rows);
+			}
+
+			_foods.resize(kept);
+			std::move(added.begin(), added.end(), std::back_inserter(_foods));
+			_pending_rows = added.size() - complete_rows;
+			_offset = last_newline - file.begin();
+			_line_number = next_line_number;
+			_size = file.size();
+			_fingerprint = fingerprint(file);
+			_report.rows_loaded = _foods.size();
+		}
+
+		// Checksum of the first and last 4 KiB before _offset.
+		uint64_t fingerprint(const MappedFile& file) const
+		{
+			size_t window = std::min<size_t>(_offset, 4096);
+			return food_snapshot_checksum(file.begin(), window)
+				^ (food_snapshot_checksum(file.begin() + _offset - window, window) * 31);
+		}
+
+		std::string _path;
+		FoodVector _foods;
+		size_t _pending_rows = 0;
+		size_t _offset = 0;
+		size_t _line_number = 1;
+		size_t _size = 0;
+		uint64_t _fingerprint = 0;
+		dev_t _device = 0;
+		ino_t _inode = 0;
+		time_t _mtime = 0;
+		bool _loaded = false;
+		FoodLoadReport _report;
+};
+
+
+// Handle of a description interned in a DescriptionStore.
+typedef uint32_t DescriptionHandle;
+
+
+// Shared, compressed storage for food descriptions.
+// Each distinct description is stored once, as a short sequence of token
+// ids into a dictionary of the space-separated words seen so far, and is
+// named by a DescriptionHandle. Token ids are varint-encoded, so with up
+// to 128 words a token takes one byte. Identical descriptions get the
+// same handle, so comparing two descriptions is an integer compare. The
+// text is only rebuilt when it is asked for.
+class DescriptionStore
+{
+	//
+	public:
+
+		//
+		DescriptionStore() : _offsets(1, 0) {}
+
+		// Intern description, returning its handle.
+		DescriptionHandle add(std::string_view description)
+		{
+			_scratch.clear();
+			size_t start = 0;
+			while ( true )
+			{
+				size_t space = description.find(' ', start);
+				std::string_view word = description.substr(start, space == std::string_view::npos ? std::string_view::npos : space - start);
+				for (uint32_t id = token_id(word); ; id >>= 7)
+				{
+					if ( id < 0x80 )
+					{
+						_scratch.push_back(uint8_t(id));
+						break;
+					}
+					_scratch.push_back(uint8_t(id | 0x80));
+				}
+				if ( space == std::string_view::npos )
+				{
+					break;
+				}
+				start = space + 1;
+			}
+
+			if ( 2 * (size() + 1) > _slots.size() )
+			{
+				rehash(std::max<size_t>(64, 2 * _slots.size()));
+			}
+
+			size_t mask = _slots.size() - 1;
+			for (size_t slot = bytes_hash(_scratch.data(), _scratch.size()) & mask; ; slot = (slot + 1) & mask)
+			{
+				if ( _slots[slot] == EMPTY_SLOT )
+				{
+					DescriptionHandle handle = DescriptionHandle(size());
+					_sequence.insert(_sequence.end(), _scratch.begin(), _scratch.end());
+					_offsets.push_back(uint32_t(_sequence.size()));
+					_slots[slot] = handle;
+					return handle;
+				}
+				if ( encoded(_slots[slot]) == std::string_view(reinterpret_cast<const char*>(_scratch.data()), _scratch.size()) )
+				{
+					return _slots[slot];
+				}
+			}
+		}
+
+		// Number of distinct descriptions.
+		size_t size() const { return _offsets.size() - 1; }
+
+		// Number of distinct words in the dictionary.
+		size_t token_count() const { return _tokens.size(); }
+
+		// The text of a description.
+		std::string text(DescriptionHandle handle) const
+		{
+			std::string result;
+			append_text(handle, result);
+			return result;
+		}
+
+		// Append the text of a description to output.
+		void append_text(DescriptionHandle handle, std::string& output) const
+		{
+			for_each_token(handle, [&](bool first, const std::string& token)
+			{
+				if ( ! first )
+				{
+					output += ' ';
+				}
+				output += token;
+			});
+		}
+
+		// Write the text of a description to out, without building a string.
+		void write(std::ostream& out, DescriptionHandle handle) const
+		{
+			for_each_token(handle, [&](bool first, const std::string& token)
+			{
+				if ( ! first )
+				{
+					out << ' ';
+				}
+				out << token;
+			});
+		}
+
+		// Approximate heap bytes held by the store.
+		size_t memory_bytes() const
+		{
+			size_t bytes = _sequence.capacity() + _offsets.capacity() * sizeof(uint32_t) + _slots.capacity() * sizeof(DescriptionHandle);
+			for (auto& token : _tokens)
+			{
+				bytes += sizeof(std::string) + token.capacity();
+			}
+			bytes += _token_ids.size() * (sizeof(std::string_view) + sizeof(uint32_t) + 2 * sizeof(void*));
+			return bytes;
+		}
+
+	//
+	private:
+
+		static constexpr DescriptionHandle EMPTY_SLOT = DescriptionHandle(-1);
+
+		uint32_t token_id(std::string_view word)
+		{
+			auto found = _token_ids.find(word);
+			if ( found != _token_ids.end() )
+			{
+				return found->second;
+			}
+			uint32_t id = uint32_t(_tokens.size());
+			_tokens.emplace_back(word);
+			_token_ids.emplace(_tokens.back(), id);
+			return id;
+		}
+
+		// The encoded token ids of a description.
+		std::string_view encoded(DescriptionHandle handle) const
+		{
+			assert(handle < size());
+			return std::string_view(
+				reinterpret_cast<const char*>(_sequence.data()) + _offsets[handle],
+				_offsets[handle + 1] - _offsets[handle]
+			);
+		}
+
+		// Call f(first, token) for each token of a description, in order.
+		template <typename F>
+		void for_each_token(DescriptionHandle handle, F&& f) const
+		{
+			std::string_view bytes = encoded(handle);
+			uint32_t id = 0;
+			int shift = 0;
+			bool first = true;
+			for (char c : bytes)
+			{
+				uint8_t byte = uint8_t(c);
+				id |= uint32_t(byte & 0x7f) << shift;
+				shift += 7;
+				if ( byte < 0x80 )
+				{
+					f(first, _tokens[id]);
+					first = false;
+					id = 0;
+					shift = 0;
+				}
+			}
+		}
+
+		static uint64_t bytes_hash(const uint8_t* bytes, size_t count)
+		{
+			uint64_t hash = 0xcbf29ce484222325ull;
+			for (size_t i = 0; i < count; i++)
+			{
+				hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+			}
+			return hash ^ (hash >> 29);
+		}
+
+		void rehash(size_t slot_count)
+		{
+			_slots.assign(slot_count, EMPTY_SLOT);
+			size_t mask = slot_count - 1;
+			for (DescriptionHandle handle = 0; handle < size(); handle++)
+			{
+				std::string_view bytes = encoded(handle);
+				size_t slot = bytes_hash(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size()) & mask;
+				while ( _slots[slot] != EMPTY_SLOT )
+				{
+					slot = (slot + 1) & mask;
+				}
+				_slots[slot] = handle;
+			}
+		}
+
+		// Dictionary words; a deque so the views in _token_ids stay valid.
+		std::deque<std::string> _tokens;
+		std::unordered_map<std::string_view, uint32_t> _token_ids;
+
+		// Encoded token ids of every description, back to back;
+		// description h is _sequence[_offsets[h] .. _offsets[h + 1]).
+		std::vector<uint8_t> _sequence;
+		std::vector<uint32_t> _offsets;
+
+		// Open-addressing table of handles by the hash of their encoding,
+		// at most half full, for interning.
+		std::vector<DescriptionHandle> _slots;
+
+		std::vector<uint8_t> _scratch;
+};
+
+
+// Convenience function to compute the total weight and calories in
+// a FoodVector.
+// Provide the FoodVector as the first argument
+// The next two arguments will return the weight and calories back to
+// the caller.
+void sum_food_vector
+(
+	const FoodVector& foods,
+	double& total_weight,
+	double& total_calories
+)
+{
+	total_weight = total_calories = 0;
+	for (auto& food : foods)
+	{
+		total_weight += food->weight();
+		total_calories += food->foodCalories();
+	}
+}
+
+
+// Convenience function to print out each FoodItem in a FoodVector,
+// followed by the total weight and calories of it.
+void print_food_vector(const FoodVector& foods)
+{
+	std::cout << "*** food Vector ***" << std::endl;
+
+	if ( foods.size() == 0 )
+	{
+		std::cout << "[empty food list]" << std::endl;
+	}
+	else
+	{
+		for (auto& food : foods)
+		{
+			std::cout
+				<< "Ye olde " << food->description()
+				<< " ==> "
+				<< "Weight of " << food->weight() << " ounces"
+				<< "; calories = " << food->foodCalories()
+				<< std::endl
+				;
+		}
+
+		double total_weight, total_calories;
+		sum_food_vector(foods, total_weight, total_calories);
+		std::cout
+			<< "> Grand total weight: " << total_weight << " ounces" << std::endl
+			<< "> Grand total calories: " << total_calories
+			<< std::endl
+			;
+	}
+}
+
+
+// Filter the vector source, i.e. create and return a new FoodVector
+// containing the subset of the food items in source that match given
+// criteria.
+// This is intended to:
+//	1) filter out food with zero or negative calories that are irrelevant to // our optimization
+//	2) limit the size of inputs to the exhaustive search algorithm since it // will probably be slow.
+//
+// Each food item that is included must have at minimum min_calories and
+// at most max_calories.
+//	(i.e., each included food item's calories must be between min_calories
+// and max_calories (inclusive).
+//
+// In addition, the the vector includes only the first total_size food items
+// that match these criteria.
+std::unique_ptr<FoodVector> filter_food_vector
+(
+	const FoodVector& source,
+	double min_calories,
+	double max_calories,
+	int total_size
+)
+{
+	// Initialize the vector that will hold the filtered items.
+	std::unique_ptr<FoodVector> FilteredFoodVector(new FoodVector);
+
+	// Loop to go through all the items in the food vector.
+	for(auto& food: source)
+	{
+		// If the item satisfies the requirements of the minimum calories, maximum
+		// calories and within the size constraints, it will be added to our filtered
+		// vector.
+		if (food->foodCalories() >= min_calories && food->foodCalories() <= max_calories)
+		{
+			if (int(FilteredFoodVector->size()) < total_size)
+			{
+				FilteredFoodVector->push_back(food);
+			}
+
+			// If we have filled up our vector, we will just break out the loop.
+			else
+			{
+				break;
+			}
+		}
+	}
+
+	// Return the vector with the filtered items
+	return FilteredFoodVector;
+}
+
+
+// Same result as filter_food_vector over load_food_database(path), but
+// rows are filtered as they are parsed and reading stops as soon as
+// total_size rows have matched.
+// Returns nullptr on I/O error.
+std::unique_ptr<FoodVector> stream_filter_food_database
+(
+	const std::string& path,
+	double min_calories,
+	double max_calories,
+	int total_size
+)
+{
+	std::unique_ptr<FoodVector> FilteredFoodVector(new FoodVector);
+
+	bool ok = visit_food_database(path, [&](std::string_view description, double weight_ounces, double calories)
+	{
+		if ( int(FilteredFoodVector->size()) >= total_size )
+		{
+			return false;
+		}
+		if ( calories >= min_calories && calories <= max_calories )
+		{
+			FilteredFoodVector->push_back(std::make_shared<FoodItem>(std::string(description), weight_ounces, calories));
+		}
+		return int(FilteredFoodVector->size()) < total_size;
+	});
+
+	if ( ! ok )
+	{
+		return nullptr;
+	}
+	return FilteredFoodVector;
+}
+
+
+// Compute the optimal set of food items with a greedy algorithm.
+// Specifically, among the food items that fit within a total_weight,
+// choose the foods whose calories-per-weight is greatest.
+// Repeat until no more food items can be chosen, either because we've
+// run out of food items, or run out of space. Ties in calories-per-weight
+// are taken in input order. The result points to the items of foods by
+// copying their shared_ptrs, so it owns them only as far as foods does:
+// items made by a FoodArena are not kept alive, and the result must not
+// outlive the arena.
+std::unique_ptr<FoodVector> greedy_max_calories
+(
+	const FoodVector& foods,
+	double total_weight
+)
+{
+	assert(foods.size() <= UINT32_MAX);
+
+	// Sort (cal/weight, index) keys rather than the items themselves, so
+	// no description is copied; ties keep input order.
+	std::vector<DensityKey> keys(foods.size());
+	for (size_t i = 0; i < foods.size(); i++)
+	{
+		keys[i] = { foods[i]->foodCalories() / foods[i]->weight(), uint32_t(i) };
+	}
+	sort_density_keys(keys);
+
+	std::unique_ptr<FoodVector> GreedyFoodVector(new FoodVector);
+
+	// This for loop will do the greedy algorithm. Chosen items are shared
+	// with foods, not copied.
+	double capacity = 0;
+	for (auto& key : keys)
+	{
+		const auto& food = foods[key.index];
+		if (capacity + food->weight() <= total_weight)
+		{
+			capacity += food->weight();
+			GreedyFoodVector->push_back(food);
+		}
+	}
+
+	// Return the vector with the items that satisfy the algorithm
+	return GreedyFoodVector;
+}
+
+
+// Greedy selection, as in greedy_max_calories, over the CSV database at
+// path, without loading the whole database into memory. Ties in
+// calories-per-weight are taken in file order.
+//
+// Greedy walks the rows in calories-per-weight order, taking each row
+// that still fits. This runs that walk in segments, one pass over the
+// file per segment. A pass keeps, in a heap, the earliest rows in greedy
+// order that come after the previous segment and that fit in the
+// remaining capacity (heavier rows can never be taken from here on). Once
+// the heap holds more than max_candidates rows whose weight is more than
+// the remaining capacity, the latest rows are dropped; the rows that are
+// kept then form the next segment of the walk, and the next pass resumes
+// after the last of them. Each segment takes at least one row, so memory
+// stays at about max_candidates rows whatever the file size, and a
+// database that fits in max_candidates rows is done in one pass.
+//
+// Returns nullptr on I/O error.
+std::unique_ptr<FoodVector> stream_greedy_max_calories
+(
+	const std::string& path,
+	double total_weight,
+	size_t max_candidates = size_t(1) << 16
+)
+{
+	// A row's place in greedy order.
+	struct Candidate
+	{
+		double percent;
+		size_t row;
+		double weight;
+		double calories;
+		std::string description;
+	};
+
+	// True when a comes before b in greedy order.
+	struct greedyBefore
+	{
+		inline bool operator() (const Candidate& a, const Candidate& b) const
+		{
+			return a.percent > b.percent || (a.percent == b.percent && a.row < b.row);
+		}
+	};
+
+	std::unique_ptr<FoodVector> GreedyFoodVector(new FoodVector);
+
+	double capacity = 0;
+	bool resume = false;
+	Candidate last{0, 0, 0, 0, ""};
+
+	for (bool done = false; ! done; )
+	{
+		double remaining = total_weight - capacity;
+
+		// A max-heap under greedyBefore: its front is the latest candidate
+		// in greedy order.
+		std::vector<Candidate> heap;
+		double heap_weight = 0;
+		bool dropped = false;
+
+		size_t row = 0;
+		bool ok = visit_food_database(path, [&](std::string_view description, double weight_ounces, double calories)
+		{
+			Candidate candidate{calories / weight_ounces, row++, weight_ounces, calories, ""};
+			if ( weight_ounces > remaining || (resume && ! greedyBefore()(last, candidate)) )
+			{
+				return true;
+			}
+			if ( heap.size() >= max_candidates && heap_weight > remaining && ! greedyBefore()(candidate, heap.front()) )
+			{
+				dropped = true;
+				return true;
+			}
+
+			candidate.description = std::string(description);
+			heap_weight += candidate.weight;
+			heap.push_back(std::move(candidate));
+			std::push_heap(heap.begin(), heap.end(), greedyBefore());
+			while ( heap.size() > max_candidates && heap_weight - heap.front().weight > remaining )
+			{
+				heap_weight -= heap.front().weight;
+				std::pop_heap(heap.begin(), heap.end(), greedyBefore());
+				heap.pop_back();
+				dropped = true;
+			}
+			return true;
+		});
+		if ( ! ok )
+		{
+			return nullptr;
+		}
+
+		// Walk this segment in greedy order.
+		std::sort_heap(heap.begin(), heap.end(), greedyBefore());
+		for (auto& candidate : heap)
+		{
+			if ( capacity + candidate.weight <= total_weight )
+			{
+				capacity += candidate.weight;
+				GreedyFoodVector->push_back(std::make_shared<FoodItem>(candidate.description, candidate.weight, candidate.calories));
+			}
+		}
+
+		done = ! dropped || heap.empty();
+		if ( ! done )
+		{
+			last = std::move(heap.back());
+			resume = true;
+		}
+	}
+
+	return GreedyFoodVector;
+}
+
+
+// The bit mask of the subset of items 0 .. n - 1 with the most calories
+// among those whose weight is at most total_weight: bit j is set when item
+// j is in it. Item j weighs weight_of(j) and has calories_of(j) calories.
+// Subsets are tried in increasing mask order and only a strictly better
+// one replaces the best so far, so ties go to the smallest mask. The empty
+// subset is the answer when no subset has positive calories.
+// n must be less than 64.
+template <typename Number, typename WeightOf, typename CaloriesOf>
+uint64_t exhaustive_best_subset(size_t n, Number total_weight, WeightOf&& weight_of, CaloriesOf&& calories_of)
+{
+	assert(n < 64);
+
+	uint64_t best_subset = 0;
+	Number best_calories = 0;
+	for (uint64_t subset = 0; subset < (uint64_t(1) << n); subset++)
+	{
+		Number subset_weight = 0, subset_calories = 0;
+		for (size_t j = 0; j < n; j++)
+		{
+			if ( (subset >> j) & 1 )
+			{
+				subset_weight += weight_of(j);
+				subset_calories += calories_of(j);
+			}
+		}
+		if ( subset_weight <= total_weight && subset_calories > best_calories )
+		{
+			best_subset = subset;
+			best_calories = subset_calories;
+		}
+	}
+	return best_subset;
+}
+
+
+// Compute the optimal set of food items with a exhaustive search algorithm.
+// Specifically, among all subsets of food items, return the subset
+// whose weight in ounces fits within the total_weight one can carry and
+// whose total calories is greatest.
+// To avoid overflow, the size of the food items vector must be less than 64.
+std::unique_ptr<FoodVector> exhaustive_max_calories
+(
+	const FoodVector& foods,
+	double total_weight
+)
+{
+	uint64_t best_subset = exhaustive_best_subset(
+		foods.size(), total_weight,
+		[&](size_t j) { return foods[j]->weight(); },
+		[&](size_t j) { return foods[j]->foodCalories(); }
+	);
+
+	// Return the vector with the items that satisfy the algorithm
+	std::unique_ptr<FoodVector> BestFoodVector(new FoodVector);
+	for (size_t j = 0; j < foods.size(); j++)
+	{
+		if ( (best_subset >> j) & 1 )
+		{
+			BestFoodVector->push_back(foods[j]);
+		}
+	}
 	return BestFoodVector;
 }
+
+
+// A solution or filter result that refers to items of a source FoodVector
+// by 32-bit index instead of holding shared_ptr copies, so building and
+// passing it around never touches the items' reference counts. The source
+// must outlive the selection and must not be changed while it is in use.
+class FoodSelection
+{
+	//
+	public:
+
+		//
+		explicit FoodSelection(const FoodVector& source) : _source(&source)
+		{
+			assert(source.size() <= UINT32_MAX);
+		}
+
+		//
+		void push_back(uint32_t index)
+		{
+			assert(index < _source->size());
+			_indices.push_back(index);
+		}
+
+		//
+		size_t size() const { return _indices.size(); }
+		bool empty() const { return _indices.empty(); }
+		const FoodVector& source() const { return *_source; }
+		const std::vector<uint32_t>& indices() const { return _indices; }
+		uint32_t index(size_t i) const { return _indices[i]; }
+
+		// The i-th selected item, viewed in place in the source.
+		const FoodItem& operator[](size_t i) const { return *(*_source)[_indices[i]]; }
+
+		// The selected items as a FoodVector sharing the source's items.
+		std::unique_ptr<FoodVector> to_food_vector() const
+		{
+			std::unique_ptr<FoodVector> foods(new FoodVector);
+			foods->reserve(_indices.size());
+			for (uint32_t i : _indices)
+			{
+				foods->push_back((*_source)[i]);
+			}
+			return foods;
+		}
+
+	//
+	private:
+
+		const FoodVector* _source;
+		std::vector<uint32_t> _indices;
+};
+
+
+// sum_food_vector for a FoodSelection.
+void sum_food_selection
+(
+	const FoodSelection& foods,
+	double& total_weight,
+	double& total_calories
+)
+{
+	total_weight = total_calories = 0;
+	for (size_t i = 0; i < foods.size(); i++)
+	{
+		total_weight += foods[i].weight();
+		total_calories += foods[i].foodCalories();
+	}
+}
+
+
+// filter_food_vector, returning the indices of the matching items.
+FoodSelection filter_food_selection
+(
+	const FoodVector& source,
+	double min_calories,
+	double max_calories,
+	int total_size
+)
+{
+	FoodSelection selection(source);
+	for (size_t i = 0; i < source.size() && int(selection.size()) < total_size; i++)
+	{
+		double calories = source[i]->foodCalories();
+		if (calories >= min_calories && calories <= max_calories)
+		{
+			selection.push_back(uint32_t(i));
+		}
+	}
+	return selection;
+}
+
+
+// The greedy walk behind greedy_max_calories_selection, with the sort
+// keys in keys.
+template <typename Keys>
+FoodSelection greedy_selection_with_keys
+(
+	const FoodVector& foods,
+	double total_weight,
+	Keys& keys
+)
+{
+	assert(foods.size() <= UINT32_MAX);
+
+	keys.resize(foods.size());
+	for (size_t i = 0; i < foods.size(); i++)
+	{
+		keys[i] = { foods[i]->foodCalories() / foods[i]->weight(), uint32_t(i) };
+	}
+	sort_density_keys(keys);
+
+	FoodSelection selection(foods);
+	double capacity = 0;
+	for (auto& key : keys)
+	{
+		double weight = foods[key.index]->weight();
+		if ( capacity + weight <= total_weight )
+		{
+			capacity += weight;
+			selection.push_back(key.index);
+		}
+	}
+	return selection;
+}
+
+
+// greedy_max_calories, returning the indices of the chosen items in the
+// order greedy chose them. Ties in calories-per-weight are taken in input
+// order.
+FoodSelection greedy_max_calories_selection
+(
+	const FoodVector& foods,
+	double total_weight
+)
+{
+	std::vector<DensityKey> keys;
+	return greedy_selection_with_keys(foods, total_weight, keys);
+}
+
+
+// As above, taking the sort keys from scratch instead of the heap.
+// Resetting and reusing one scratch arena across calls avoids allocating
+// the keys on every call.
+FoodSelection greedy_max_calories_selection
+(
+	const FoodVector& foods,
+	double total_weight,
+	MonotonicArena& scratch
+)
+{
+	std::vector<DensityKey, ArenaAllocator<DensityKey>> keys{ArenaAllocator<DensityKey>(scratch)};
+	return greedy_selection_with_keys(foods, total_weight, keys);
+}
+
+
+// greedy_max_calories_selection starting from a prebuilt DensityIndex of
+// foods, so nothing is sorted: the leading items of the index that fit are
+// taken at once, and only the rest of the index is walked.
+FoodSelection greedy_max_calories_selection
+(
+	const FoodVector& foods,
+	double total_weight,
+	const DensityIndex& index
+)
+{
+	assert(index.size() == foods.size());
+
+	FoodSelection selection(foods);
+	size_t taken = index.critical_position(total_weight);
+	for (size_t k = 0; k < taken; k++)
+	{
+		selection.push_back(index.order[k]);
+	}
+
+	double capacity = index.prefix_weight[taken];
+	for (size_t k = taken; k < index.size(); k++)
+	{
+		double weight = foods[index.order[k]]->weight();
+		if ( capacity + weight <= total_weight )
+		{
+			capacity += weight;
+			selection.push_back(index.order[k]);
+		}
+	}
+	return selection;
+}
+
+
+// exhaustive_max_calories, returning the indices of the best subset in
+// input order. Each subset is a bit mask, so no candidate vectors are
+// built.
+FoodSelection exhaustive_max_calories_selection
+(
+	const FoodVector& foods,
+	double total_weight
+)
+{
+	size_t n = foods.size();
+
+	std::vector<double> weights(n), calories(n);
+	for (size_t j = 0; j < n; j++)
+	{
+		weights[j] = foods[j]->weight();
+		calories[j] = foods[j]->foodCalories();
+	}
+
+	uint64_t best_subset = exhaustive_best_subset(
+		n, total_weight,
+		[&](size_t j) { return weights[j]; },
+		[&](size_t j) { return calories[j]; }
+	);
+
+	FoodSelection selection(foods);
+	for (size_t j = 0; j < n; j++)
+	{
+		if ( (best_subset >> j) & 1 )
+		{
+			selection.push_back(uint32_t(j));
+		}
+	}
+	return selection;
+}
+
+
+// greedy_max_calories for each capacity in total_weights, from one
+// DensityIndex of foods instead of one sort per capacity. The capacities
+// are shared out among thread_count threads, each filling from the same
+// index. result[q] holds the same items, in the same order, as
+// greedy_max_calories(foods, total_weights[q]).
+std::vector<std::unique_ptr<FoodVector>> greedy_max_calories_batch
+(
+	const FoodVector& foods,
+	const std::vector<double>& total_weights,
+	const DensityIndex& index,
+	unsigned thread_count = std::thread::hardware_concurrency()
+)
+{
+	std::vector<std::unique_ptr<FoodVector>> result(total_weights.size());
+
+	thread_count = std::max(1u, thread_count);
+	thread_count = unsigned(std::min<size_t>(thread_count, total_weights.size()));
+
+	// Worker i answers queries i, i + thread_count, ...; neighbouring
+	// capacities cost about the same, so this keeps the workers even.
+	auto fill = [&](unsigned i)
+	{
+		for (size_t q = i; q < total_weights.size(); q += thread_count)
+		{
+			result[q] = greedy_max_calories_selection(foods, total_weights[q], index).to_food_vector();
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (unsigned i = 1; i < thread_count; i++)
+	{
+		workers.emplace_back(fill, i);
+	}
+	if ( thread_count > 0 )
+	{
+		fill(0);
+	}
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+	return result;
+}
+
+
+// As above, building the DensityIndex of foods first.
+std::vector<std::unique_ptr<FoodVector>> greedy_max_calories_batch
+(
+	const FoodVector& foods,
+	const std::vector<double>& total_weights,
+	unsigned thread_count = std::thread::hardware_concurrency()
+)
+{
+	return greedy_max_calories_batch(foods, total_weights, build_density_index(foods), thread_count);
+}
+
+
+// greedy_max_calories_selection that only sorts as much of the density
+// order as greedy uses, for capacities that are small next to the total
+// weight of foods. Each round partitions the next batch of items in
+// greedy order to the front of the unsorted pool with std::nth_element,
+// sorts and walks just that batch, and doubles the batch size for the
+// next round. Before every round, the items that no longer fit in the
+// remaining capacity are dropped from the pool; they can never be taken
+// later, since the capacity used only grows. Greedy is over when the pool
+// is empty. The selection, including the order of ties, is the same as
+// greedy_max_calories_selection's.
+FoodSelection greedy_max_calories_partial_selection
+(
+	const FoodVector& foods,
+	double total_weight,
+	size_t first_batch = 1024
+)
+{
+	assert(foods.size() <= UINT32_MAX);
+
+	struct WeightedKey
+	{
+		DensityKey key;
+		double weight;
+	};
+	auto before = [](const WeightedKey& a, const WeightedKey& b) { return density_key_before(a.key, b.key); };
+
+	std::vector<WeightedKey> pool(foods.size());
+	for (size_t i = 0; i < foods.size(); i++)
+	{
+		double weight = foods[i]->weight();
+		pool[i] = { { foods[i]->foodCalories() / weight, uint32_t(i) }, weight };
+	}
+
+	FoodSelection selection(foods);
+	double capacity = 0;
+	size_t batch = std::max<size_t>(first_batch, 1);
+	auto begin = pool.begin(), end = pool.end();
+	while ( true )
+	{
+		end = std::remove_if(begin, end, [&](const WeightedKey& item) { return capacity + item.weight > total_weight; });
+		if ( begin == end )
+		{
+			break;
+		}
+
+		auto middle = begin + std::min<size_t>(batch, end - begin);
+		std::nth_element(begin, middle, end, before);
+		std::sort(begin, middle, before);
+		for (auto item = begin; item != middle; ++item)
+		{
+			if ( capacity + item->weight <= total_weight )
+			{
+				capacity += item->weight;
+				selection.push_back(item->key.index);
+			}
+		}
+
+		begin = middle;
+		batch *= 2;
+	}
+	return selection;
+}
+
+
+// greedy_max_calories through greedy_max_calories_partial_selection.
+std::unique_ptr<FoodVector> greedy_max_calories_partial
+(
+	const FoodVector& foods,
+	double total_weight
+)
+{
+	return greedy_max_calories_partial_selection(foods, total_weight).to_food_vector();
+}
+
+
+// Run work(0), ..., work(thread_count - 1) at once, work(0) on the
+// calling thread and the rest on new threads, and wait for all of them.
+template <typename Work>
+void run_food_workers(unsigned thread_count, Work&& work)
+{
+	std::vector<std::thread> workers;
+	for (unsigned i = 1; i < thread_count; i++)
+	{
+		workers.emplace_back(work, i);
+	}
+	work(0u);
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+
+// greedy_max_calories_selection on thread_count threads.
+//
+// 1. Sort: each thread sorts the keys of one contiguous range of foods
+//    with sort_density_keys, then sorted ranges are merged in pairs, in
+//    parallel, until one remains. density_key_before is a total order,
+//    so the merged order is exactly the sequential one.
+// 2. Prefix: the weights are gathered into greedy order in parallel, and
+//    summed in order up to the critical item, the first that does not
+//    fit. This sum stays on one thread on purpose: a parallel scan would
+//    add the weights in a different order, and its rounding could move
+//    the critical item or change the capacity the skip phase starts
+//    with. It is one pass of additions over a contiguous array.
+// 3. Skip phase: in parallel, each thread keeps those of its range of the
+//    items after the critical one that fit in the capacity left after
+//    the prefix. An item that does not fit then never fits later, so the
+//    sequential walk that follows only visits the survivors.
+//
+// The selection is the same as greedy_max_calories_selection's.
+FoodSelection greedy_max_calories_parallel_selection
+(
+	const FoodVector& foods,
+	double total_weight,
+	unsigned thread_count = std::thread::hardware_concurrency()
+)
+{
+	assert(foods.size() <= UINT32_MAX);
+
+	const size_t n = foods.size();
+	thread_count = std::max(1u, thread_count);
+	thread_count = unsigned(std::min<size_t>(thread_count, n / 4096 + 1));
+
+	// Range i is [bounds[i], bounds[i + 1]).
+	std::vector<size_t> bounds(thread_count + 1);
+	for (unsigned i = 0; i <= thread_count; i++)
+	{
+		bounds[i] = n / thread_count * i + std::min<size_t>(i, n % thread_count);
+	}
+
+	std::vector<DensityKey> keys(n);
+	run_food_workers(thread_count, [&](unsigned t)
+	{
+		for (size_t i = bounds[t]; i < bounds[t + 1]; i++)
+		{
+			keys[i] = { foods[i]->foodCalories() / foods[i]->weight(), uint32_t(i) };
+		}
+		std::vector<DensityKey> range(keys.begin() + bounds[t], keys.begin() + bounds[t + 1]);
+		sort_density_keys(range);
+		std::copy(range.begin(), range.end(), keys.begin() + bounds[t]);
+	});
+
+	std::vector<DensityKey> merged(n);
+	for (size_t width = 1; width < thread_count; width *= 2)
+	{
+		unsigned merges = unsigned((thread_count + 2 * width - 1) / (2 * width));
+		run_food_workers(merges, [&](unsigned m)
+		{
+			size_t first = bounds[std::min<size_t>(2 * width * m, thread_count)];
+			size_t middle = bounds[std::min<size_t>(2 * width * m + width, thread_count)];
+			size_t last = bounds[std::min<size_t>(2 * width * (m + 1), thread_count)];
+			std::merge(keys.begin() + first, keys.begin() + middle, keys.begin() + middle, keys.begin() + last,
+				merged.begin() + first, density_key_before);
+		});
+		keys.swap(merged);
+	}
+
+	std::vector<double> weights(n);
+	run_food_workers(thread_count, [&](unsigned t)
+	{
+		for (size_t k = bounds[t]; k < bounds[t + 1]; k++)
+		{
+			weights[k] = foods[keys[k].index]->weight();
+		}
+	});
+
+	FoodSelection selection(foods);
+	double capacity = 0;
+	size_t critical = 0;
+	while ( critical < n && capacity + weights[critical] <= total_weight )
+	{
+		capacity += weights[critical];
+		critical++;
+	}
+	for (size_t k = 0; k < critical; k++)
+	{
+		selection.push_back(keys[k].index);
+	}
+
+	// Positions after the critical item that fit, per range, in order.
+	std::vector<std::vector<size_t>> fits(thread_count);
+	run_food_workers(thread_count, [&](unsigned t)
+	{
+		for (size_t k = std::max(bounds[t], critical); k < bounds[t + 1]; k++)
+		{
+			if ( capacity + weights[k] <= total_weight )
+			{
+				fits[t].push_back(k);
+			}
+		}
+	});
+	for (auto& range : fits)
+	{
+		for (size_t k : range)
+		{
+			if ( capacity + weights[k] <= total_weight )
+			{
+				capacity += weights[k];
+				selection.push_back(keys[k].index);
+			}
+		}
+	}
+	return selection;
+}
+
+
+// greedy_max_calories through greedy_max_calories_parallel_selection.
+std::unique_ptr<FoodVector> greedy_max_calories_parallel
+(
+	const FoodVector& foods,
+	double total_weight,
+	unsigned thread_count = std::thread::hardware_concurrency()
+)
+{
+	return greedy_max_calories_parallel_selection(foods, total_weight, thread_count).to_food_vector();
+}
+
+
+// A greedy answer with a proven bound on how far it is from optimal.
+// upper_bound is the fractional (Dantzig) bound: no subset of the foods
+// that fits has more calories, so the optimum lies in
+// [calories, upper_bound].
+struct GreedyApproximation
+{
+	explicit GreedyApproximation(const FoodVector& foods) : selection(foods) {}
+
+	FoodSelection selection;
+	double weight = 0;
+	double calories = 0;
+	double upper_bound = 0;
+
+	// True when the best single item beat greedy's packing.
+	bool single_item = false;
+
+	// How many calories an optimal selection could have beyond this one.
+	double gap() const { return upper_bound - calories; }
+};
+
+
+// Greedy with a guaranteed 1/2 approximation: the better of greedy's
+// packing and the best single item that fits, so calories is always at
+// least half of upper_bound, and so of the optimum.
+// Only items that fit on their own and have positive calories are
+// considered; the others cannot be part of a better selection. Among
+// those, greedy is the same as greedy_max_calories_selection. The walk
+// that packs greedy's selection also finds the critical item, the first
+// that does not fit, and upper_bound is the calories packed before it
+// plus the fraction of it that fills the remaining capacity.
+GreedyApproximation greedy_max_calories_approximation
+(
+	const FoodVector& foods,
+	double total_weight
+)
+{
+	assert(foods.size() <= UINT32_MAX);
+
+	GreedyApproximation result(foods);
+
+	std::vector<DensityKey> keys;
+	const FoodItem* best = nullptr;
+	uint32_t best_index = 0;
+	for (size_t i = 0; i < foods.size(); i++)
+	{
+		const FoodItem& food = *foods[i];
+		if ( food.foodCalories() > 0 && food.weight() <= total_weight )
+		{
+			keys.push_back({ food.foodCalories() / food.weight(), uint32_t(i) });
+			if ( ! best || food.foodCalories() > best->foodCalories() )
+			{
+				best = &food;
+				best_index = uint32_t(i);
+			}
+		}
+	}
+	sort_density_keys(keys);
+
+	bool critical_found = false;
+	for (auto& key : keys)
+	{
+		const FoodItem& food = *foods[key.index];
+		if ( result.weight + food.weight() <= total_weight )
+		{
+			result.weight += food.weight();
+			result.calories += food.foodCalories();
+			result.selection.push_back(key.index);
+		}
+		else if ( ! critical_found )
+		{
+			result.upper_bound = result.calories + (total_weight - result.weight) * key.percent;
+			critical_found = true;
+		}
+	}
+	if ( ! critical_found )
+	{
+		result.upper_bound = result.calories;
+	}
+
+	if ( best && best->foodCalories() > result.calories )
+	{
+		result.selection = FoodSelection(foods);
+		result.selection.push_back(best_index);
+		result.weight = best->weight();
+		result.calories = best->foodCalories();
+		result.single_item = true;
+	}
+	return result;
+}
+
+
+// The critical item of a knapsack: the first item, in greedy order, that
+// does not fit after every item before it is packed, and the fractional
+// (Dantzig) bound it gives.
+struct CriticalItem
+{
+	explicit CriticalItem(const FoodVector& foods) : above(foods) {}
+
+	// The items before the critical item in greedy order, in input order:
+	// those with greater calories-per-weight, and those with equal
+	// calories-per-weight and a lower index. They all fit together.
+	FoodSelection above;
+	double above_weight = 0;
+	double above_calories = 0;
+
+	// False when every item fits, and then there is no critical item.
+	bool found = false;
+	uint32_t index = 0;
+
+	// above_calories plus the fraction of the critical item that fills
+	// the remaining capacity: the optimum of the fractional knapsack.
+	double fractional_bound = 0;
+};
+
+
+// Find the critical item of foods in expected O(n), without sorting, in
+// the manner of Balas and Zemel: partition the candidates around their
+// median in greedy order with std::nth_element; if the half before the
+// median fits in the remaining capacity, pack it and the median and go on
+// with the half after it, otherwise go on with the half before it. Each
+// round halves the candidates.
+// As in greedy_max_calories_approximation, only items that fit on their
+// own and have positive calories are considered, so fractional_bound is
+// that function's upper_bound. Weights are summed by halves rather than
+// item by item, so when the critical item only just fails to fit,
+// rounding can make the result differ from a sorted walk's.
+CriticalItem find_critical_item
+(
+	const FoodVector& foods,
+	double total_weight
+)
+{
+	assert(foods.size() <= UINT32_MAX);
+
+	struct WeightedKey
+	{
+		DensityKey key;
+		double weight;
+		double calories;
+	};
+	auto before = [](const WeightedKey& a, const WeightedKey& b) { return density_key_before(a.key, b.key); };
+
+	std::vector<WeightedKey> items;
+	for (size_t i = 0; i < foods.size(); i++)
+	{
+		const FoodItem& food = *foods[i];
+		if ( food.foodCalories() > 0 && food.weight() <= total_weight )
+		{
+			items.push_back({ { food.foodCalories() / food.weight(), uint32_t(i) }, food.weight(), food.foodCalories() });
+		}
+	}
+
+	CriticalItem result(foods);
+	double remaining = total_weight;
+
+	// Everything before first is packed; the critical item, if any, is in
+	// [first, last).
+	auto first = items.begin(), last = items.end();
+	while ( first != last )
+	{
+		auto median = first + (last - first) / 2;
+		std::nth_element(first, median, last, before);
+
+		double weight = 0, calories = 0;
+		for (auto item = first; item != median; ++item)
+		{
+			weight += item->weight;
+			calories += item->calories;
+		}
+
+		if ( weight > remaining )
+		{
+			last = median;
+			continue;
+		}
+
+		remaining -= weight;
+		result.above_weight += weight;
+		result.above_calories += calories;
+		if ( median->weight > remaining )
+		{
+			result.found = true;
+			result.index = median->key.index;
+			first = median;
+			break;
+		}
+		remaining -= median->weight;
+		result.above_weight += median->weight;
+		result.above_calories += median->calories;
+		first = median + 1;
+	}
+
+	result.fractional_bound = result.above_calories;
+	if ( result.found )
+	{
+		result.fractional_bound += remaining * first->key.percent;
+	}
+
+	std::vector<bool> packed(foods.size(), false);
+	for (auto item = items.begin(); item != first; ++item)
+	{
+		packed[item->key.index] = true;
+	}
+	for (size_t i = 0; i < foods.size(); i++)
+	{
+		if ( packed[i] )
+		{
+			result.above.push_back(uint32_t(i));
+		}
+	}
+	return result;
+}
+
+
+// A selection after local search, with its totals.
+struct ImprovedSelection
+{
+	explicit ImprovedSelection(const FoodVector& foods) : selection(foods) {}
+
+	FoodSelection selection;
+	double weight = 0;
+	double calories = 0;
+
+	// How many moves were applied.
+	size_t moves = 0;
+
+	// True when no move improves selection; false when the budget ran out
+	// first.
+	bool converged = false;
+};
+
+
+// Improve start, a selection that fits in total_weight (typically
+// greedy's), by local search, until no move adds calories or budget has
+// passed. The moves, tried in this order, are:
+//	drop: remove a chosen item with calories <= 0;
+//	insert: add an unchosen item that fits in the leftover capacity;
+//	1-out/1-in: replace a chosen item by an unchosen one with more
+//		calories;
+//	1-out/2-in: replace a chosen item by two unchosen ones with more
+//		calories together;
+//	2-out/1-in: replace two chosen items by one unchosen one with more
+//		calories than both.
+// The first improving move found is applied, then the search starts over.
+// The foods are sorted by weight once; after each move, the best and
+// second best unchosen items at or below every weight are recomputed in
+// one O(n) pass, so each candidate move is checked with a binary search
+// for the best item that fits in the capacity it frees. A 1-out/2-in
+// move tries each unchosen item that fits as the first of the two, so a
+// pass over all moves takes O(k n log n) for k chosen items. Totals are
+// updated by each move's weight and calorie deltas, not summed again.
+// Chosen items keep their places in the selection; an inserted item, or
+// the second of two that replace one, is appended.
+// budget counts from the call. The sort by weight always runs, so a
+// budget shorter than it ends the search before the first move.
+ImprovedSelection improve_food_selection
+(
+	const FoodSelection& start,
+	double total_weight,
+	std::chrono::microseconds budget
+)
+{
+	const auto deadline = std::chrono::steady_clock::now() + budget;
+	const FoodVector& foods = start.source();
+	const size_t n = foods.size();
+	const uint32_t none = UINT32_MAX;
+
+	ImprovedSelection result(foods);
+	sum_food_selection(start, result.weight, result.calories);
+
+	std::vector<uint32_t> chosen(start.indices());
+	std::vector<bool> is_chosen(n, false);
+	for (uint32_t i : chosen)
+	{
+		is_chosen[i] = true;
+	}
+
+	// Sorting by decreasing negated weight is sorting by increasing weight,
+	// and lets the radix sort of sort_density_keys do it.
+	std::vector<DensityKey> weight_order(n);
+	for (size_t i = 0; i < n; i++)
+	{
+		weight_order[i] = { -foods[i]->weight(), uint32_t(i) };
+	}
+	sort_density_keys(weight_order);
+	std::vector<uint32_t> by_weight(n);
+	std::vector<double> sorted_weights(n);
+	for (size_t k = 0; k < n; k++)
+	{
+		sorted_weights[k] = -weight_order[k].percent;
+		by_weight[k] = weight_order[k].index;
+	}
+
+	// best_upto[k], second_upto[k]: the unchosen items with the most and
+	// second most calories among by_weight[0 .. k], or none.
+	std::vector<uint32_t> best_upto(n), second_upto(n);
+	auto refresh = [&]()
+	{
+		uint32_t best = none, second = none;
+		for (size_t k = 0; k < n; k++)
+		{
+			uint32_t i = by_weight[k];
+			if ( ! is_chosen[i] )
+			{
+				if ( best == none || foods[i]->foodCalories() > foods[best]->foodCalories() )
+				{
+					second = best;
+					best = i;
+				}
+				else if ( second == none || foods[i]->foodCalories() > foods[second]->foodCalories() )
+				{
+					second = i;
+				}
+			}
+			best_upto[k] = best;
+			second_upto[k] = second;
+		}
+	};
+	// The unchosen item other than except with the most calories and
+	// weight at most room.
+	auto best_within = [&](double room, uint32_t except = UINT32_MAX)
+	{
+		size_t k = size_t(std::upper_bound(sorted_weights.begin(), sorted_weights.end(), room) - sorted_weights.begin());
+		if ( k == 0 )
+		{
+			return none;
+		}
+		return best_upto[k - 1] == except ? second_upto[k - 1] : best_upto[k - 1];
+	};
+	auto out_of_time = [&]() { return std::chrono::steady_clock::now() >= deadline; };
+
+	// What one pass over the moves did.
+	enum class Step
+	{
+		moved,
+		no_move,
+		out_of_time
+	};
+
+	// Try every move once; apply the first that improves.
+	auto improve = [&]()
+	{
+		for (size_t a = 0; a < chosen.size(); a++)
+		{
+			const FoodItem& out = *foods[chosen[a]];
+			if ( out.foodCalories() <= 0 )
+			{
+				is_chosen[chosen[a]] = false;
+				result.weight -= out.weight();
+				result.calories -= out.foodCalories();
+				chosen.erase(chosen.begin() + a);
+				return Step::moved;
+			}
+		}
+
+		uint32_t in = best_within(total_weight - result.weight);
+		if ( in != none && foods[in]->foodCalories() > 0 && result.weight + foods[in]->weight() <= total_weight )
+		{
+			is_chosen[in] = true;
+			result.weight += foods[in]->weight();
+			result.calories += foods[in]->foodCalories();
+			chosen.push_back(in);
+			return Step::moved;
+		}
+
+		for (size_t a = 0; a < chosen.size(); a++)
+		{
+			const FoodItem& out = *foods[chosen[a]];
+			double weight = result.weight - out.weight();
+			uint32_t in = best_within(total_weight - weight);
+			if ( in != none && foods[in]->foodCalories() > out.foodCalories() && weight + foods[in]->weight() <= total_weight )
+			{
+				is_chosen[chosen[a]] = false;
+				is_chosen[in] = true;
+				result.weight = weight + foods[in]->weight();
+				result.calories += foods[in]->foodCalories() - out.foodCalories();
+				chosen[a] = in;
+				return Step::moved;
+			}
+		}
+
+		for (size_t a = 0; a < chosen.size(); a++)
+		{
+			if ( out_of_time() )
+			{
+				return Step::out_of_time;
+			}
+			const FoodItem& out = *foods[chosen[a]];
+			double room = total_weight - (result.weight - out.weight());
+			for (size_t k = 0; k < n && sorted_weights[k] <= room; k++)
+			{
+				uint32_t first = by_weight[k];
+				if ( is_chosen[first] || foods[first]->foodCalories() <= 0 )
+				{
+					continue;
+				}
+				double weight = result.weight - out.weight() + foods[first]->weight();
+				uint32_t second = best_within(total_weight - weight, first);
+				if ( second != none
+					&& foods[first]->foodCalories() + foods[second]->foodCalories() > out.foodCalories()
+					&& weight + foods[second]->weight() <= total_weight )
+				{
+					is_chosen[chosen[a]] = false;
+					is_chosen[first] = is_chosen[second] = true;
+					result.weight = weight + foods[second]->weight();
+					result.calories += foods[first]->foodCalories() + foods[second]->foodCalories() - out.foodCalories();
+					chosen[a] = first;
+					chosen.push_back(second);
+					return Step::moved;
+				}
+			}
+		}
+
+		for (size_t a = 0; a < chosen.size(); a++)
+		{
+			if ( out_of_time() )
+			{
+				return Step::out_of_time;
+			}
+			const FoodItem& first = *foods[chosen[a]];
+			for (size_t b = a + 1; b < chosen.size(); b++)
+			{
+				const FoodItem& second = *foods[chosen[b]];
+				double weight = result.weight - first.weight() - second.weight();
+				uint32_t in = best_within(total_weight - weight);
+				if ( in != none && foods[in]->foodCalories() > first.foodCalories() + second.foodCalories()
+					&& weight + foods[in]->weight() <= total_weight )
+				{
+					is_chosen[chosen[a]] = is_chosen[chosen[b]] = false;
+					is_chosen[in] = true;
+					result.weight = weight + foods[in]->weight();
+					result.calories += foods[in]->foodCalories() - first.foodCalories() - second.foodCalories();
+					chosen[a] = in;
+					chosen.erase(chosen.begin() + b);
+					return Step::moved;
+				}
+			}
+		}
+		return Step::no_move;
+	};
+
+	Step step = Step::out_of_time;
+	while ( ! out_of_time() )
+	{
+		refresh();
+		step = improve();
+		if ( step != Step::moved )
+		{
+			break;
+		}
+		result.moves++;
+	}
+	result.converged = step == Step::no_move;
+
+	for (uint32_t i : chosen)
+	{
+		result.selection.push_back(i);
+	}
+	return result;
+}
+
+
+// greedy_max_calories followed by improve_food_selection.
+std::unique_ptr<FoodVector> greedy_max_calories_improved
+(
+	const FoodVector& foods,
+	double total_weight,
+	std::chrono::microseconds budget
+)
+{
+	return improve_food_selection(greedy_max_calories_selection(foods, total_weight), total_weight, budget).selection.to_food_vector();
+}
+
+
+// Fixed-point food quantity: hundredths of an ounce, or hundredths of a
+// calorie. food.csv has two decimals, so every value is exact.
+typedef int64_t FoodCenti;
+
+
+// How a FoodTable column type converts to and from the doubles parsed out
+// of the CSV file and held by FoodItem.
+template <typename Number>
+struct FoodNumber;
+
+// Ounces and calories as parsed.
+template <>
+struct FoodNumber<double>
+{
+	static bool from_double(double value, double& output)
+	{
+		output = value;
+		return true;
+	}
+
+	static double round_from_double(double value) { return value; }
+
+	static double to_double(double value) { return value; }
+};
+
+// Hundredths. from_double only accepts values with at most two decimals.
+template <>
+struct FoodNumber<FoodCenti>
+{
+	static bool from_double(double value, FoodCenti& output)
+	{
+		double scaled = value * 100;
+		double rounded = std::round(scaled);
+		if ( std::abs(scaled - rounded) > 1e-6 * std::max(1.0, std::abs(scaled)) || std::abs(rounded) > 9e15 )
+		{
+			return false;
+		}
+		output = FoodCenti(rounded);
+		return true;
+	}
+
+	static FoodCenti round_from_double(double value) { return FoodCenti(std::llround(value * 100)); }
+
+	static double to_double(FoodCenti value) { return double(value) / 100; }
+};
+
+
+// A structure-of-arrays alternative to FoodVector.
+// Weights, calories and description handles are kept in three contiguous
+// columns, so scans over weights or calories read consecutive memory
+// instead of following one pointer per item. Descriptions live in a
+// DescriptionStore that may be shared with other tables, e.g. the tables
+// returned by filter_food_table and the solvers, which copy only handles.
+// Number is the type of the weight and calorie columns: double for
+// FoodTable, or FoodCenti for FixedFoodTable, where solvers work in exact
+// integer arithmetic.
+template <typename Number>
+class BasicFoodTable
+{
+	//
+	public:
+
+		// The type of the weight and calorie columns.
+		typedef Number value_type;
+
+		// An empty table with its own DescriptionStore.
+		BasicFoodTable() : _descriptions(std::make_shared<DescriptionStore>()) {}
+
+		// An empty table whose descriptions go into descriptions.
+		explicit BasicFoodTable(std::shared_ptr<DescriptionStore> descriptions)
+			:
+			_descriptions(std::move(descriptions))
+		{
+			assert(_descriptions);
+		}
+
+		// Append a row, interning its description.
+		void push_back(std::string_view description, Number weight, Number calories)
+		{
+			assert(!description.empty());
+			push_back(_descriptions->add(description), weight, calories);
+		}
+
+		// Append a row whose description is already in this table's store.
+		void push_back(DescriptionHandle description, Number weight, Number calories)
+		{
+			assert(description < _descriptions->size());
+			assert(weight > 0);
+			_weights.push_back(weight);
+			_calories.push_back(calories);
+			_handles.push_back(description);
+			_density_index.reset();
+		}
+
+		//
+		void reserve(size_t n)
+		{
+			_weights.reserve(n);
+			_calories.reserve(n);
+			_handles.reserve(n);
+		}
+
+		//
+		size_t size() const { return _weights.size(); }
+		bool empty() const { return _weights.empty(); }
+
+		// Columns.
+		const Number* weights() const { return _weights.data(); }
+		const Number* calories() const { return _calories.data(); }
+		const DescriptionHandle* description_handles() const { return _handles.data(); }
+
+		// One row.
+		Number weight(size_t i) const { return _weights[i]; }
+		Number foodCalories(size_t i) const { return _calories[i]; }
+		DescriptionHandle description_handle(size_t i) const { return _handles[i]; }
+		std::string description(size_t i) const { return _descriptions->text(_handles[i]); }
+
+		//
+		const DescriptionStore& descriptions() const { return *_descriptions; }
+		const std::shared_ptr<DescriptionStore>& shared_descriptions() const { return _descriptions; }
+
+		// The table's density index, built on first use and kept until the
+		// table changes. Concurrent calls are safe: the index is published
+		// with an atomic compare-and-swap, so threads that race on the first
+		// call may each build one, but all of them return the one stored.
+		const BasicDensityIndex<Number>& density_index() const
+		{
+			std::shared_ptr<const BasicDensityIndex<Number>> index = std::atomic_load(&_density_index);
+			if ( ! index )
+			{
+				auto built = std::make_shared<const BasicDensityIndex<Number>>(build_density_index(*this));
+				if ( std::atomic_compare_exchange_strong(&_density_index, &index, built) )
+				{
+					index = built;
+				}
+			}
+			return *index;
+		}
+
+	//
+	private:
+
+		std::shared_ptr<DescriptionStore> _descriptions;
+		std::vector<Number> _weights;
+		std::vector<Number> _calories;
+		std::vector<DescriptionHandle> _handles;
+		mutable std::shared_ptr<const BasicDensityIndex<Number>> _density_index;
+};
+
+
+// Weights in ounces and calories as doubles.
+typedef BasicFoodTable<double> FoodTable;
+
+// Weights and calories in exact hundredths.
+typedef BasicFoodTable<FoodCenti> FixedFoodTable;
+
+
+// Copy a FoodVector into a new table, in the same order. For a
+// FixedFoodTable, values are rounded to the nearest hundredth.
+template <typename Number = double>
+std::unique_ptr<BasicFoodTable<Number>> make_food_table(const FoodVector& foods)
+{
+	std::unique_ptr<BasicFoodTable<Number>> table(new BasicFoodTable<Number>);
+	table->reserve(foods.size());
+	for (auto& food : foods)
+	{
+		table->push_back(
+			food->description(),
+			FoodNumber<Number>::round_from_double(food->weight()),
+			FoodNumber<Number>::round_from_double(food->foodCalories())
+		);
+	}
+	return table;
+}
+
+
+// Copy a table into a new FoodVector, in the same order.
+template <typename Number>
+std::unique_ptr<FoodVector> to_food_vector(const BasicFoodTable<Number>& table)
+{
+	std::unique_ptr<FoodVector> foods(new FoodVector);
+	foods->reserve(table.size());
+	for (size_t i = 0; i < table.size(); i++)
+	{
+		foods->push_back(std::make_shared<FoodItem>(
+			table.description(i),
+			FoodNumber<Number>::to_double(table.weight(i)),
+			FoodNumber<Number>::to_double(table.foodCalories(i))
+		));
+	}
+	return foods;
+}
+
+
+// Load the CSV database straight into a table, with the same rows and
+// errors as load_food_database. The column type is chosen here:
+// load_food_table<FoodCenti> loads a FixedFoodTable, and also skips rows
+// whose weight or calories have more than two decimals.
+// Returns nullptr on I/O error.
+template <typename Number = double>
+std::unique_ptr<BasicFoodTable<Number>> load_food_table(const std::string& path)
+{
+	MappedFile file(path);
+	if ( ! file.is_open() )
+	{
+		std::cout << "Failed to load food database; Cannot open file: " << path << std::endl;
+		return nullptr;
+	}
+
+	std::unique_ptr<BasicFoodTable<Number>> table(new BasicFoodTable<Number>);
+	bool ok = parse_food_rows(
+		file.begin(), file.end(), 1,
+		[&](std::string_view description, double weight_ounces, double calories)
+		{
+			Number weight_value, calories_value;
+			if (
+				FoodNumber<Number>::from_double(weight_ounces, weight_value)
+				&& FoodNumber<Number>::from_double(calories, calories_value)
+				&& weight_value > 0
+			)
+			{
+				table->push_back(description, weight_value, calories_value);
+			}
+		}
+	);
+	if ( ! ok )
+	{
+		return nullptr;
+	}
+	return table;
+}
+
+
+// sum_food_vector for a table.
+template <typename Number>
+void sum_food_table
+(
+	const BasicFoodTable<Number>& foods,
+	Number& total_weight,
+	Number& total_calories
+)
+{
+	const Number* weights = foods.weights();
+	const Number* calories = foods.calories();
+	total_weight = total_calories = 0;
+	for (size_t i = 0; i < foods.size(); i++)
+	{
+		total_weight += weights[i];
+		total_calories += calories[i];
+	}
+}
+
+
+// print_food_vector for a table. Descriptions are decoded as they are
+// printed; quantities are printed in ounces and calories.
+template <typename Number>
+void print_food_table(const BasicFoodTable<Number>& foods)
+{
+	std::cout << "*** food Vector ***" << std::endl;
+
+	if ( foods.size() == 0 )
+	{
+		std::cout << "[empty food list]" << std::endl;
+	}
+	else
+	{
+		for (size_t i = 0; i < foods.size(); i++)
+		{
+			std::cout << "Ye olde ";
+			foods.descriptions().write(std::cout, foods.description_handle(i));
+			std::cout
+				<< " ==> "
+				<< "Weight of " << FoodNumber<Number>::to_double(foods.weight(i)) << " ounces"
+				<< "; calories = " << FoodNumber<Number>::to_double(foods.foodCalories(i))
+				<< std::endl
+				;
+		}
+
+		Number total_weight, total_calories;
+		sum_food_table(foods, total_weight, total_calories);
+		std::cout
+			<< "> Grand total weight: " << FoodNumber<Number>::to_double(total_weight) << " ounces" << std::endl
+			<< "> Grand total calories: " << FoodNumber<Number>::to_double(total_calories)
+			<< std::endl
+			;
+	}
+}
+
+
+// filter_food_vector for a table; min_calories and max_calories are in
+// the table's units. The result shares source's DescriptionStore.
+template <typename Number>
+std::unique_ptr<BasicFoodTable<Number>> filter_food_table
+(
+	const BasicFoodTable<Number>& source,
+	typename BasicFoodTable<Number>::value_type min_calories,
+	typename BasicFoodTable<Number>::value_type max_calories,
+	int total_size
+)
+{
+	std::unique_ptr<BasicFoodTable<Number>> FilteredFoodTable(new BasicFoodTable<Number>(source.shared_descriptions()));
+
+	const Number* calories = source.calories();
+	for (size_t i = 0; i < source.size() && int(FilteredFoodTable->size()) < total_size; i++)
+	{
+		if (calories[i] >= min_calories && calories[i] <= max_calories)
+		{
+			FilteredFoodTable->push_back(source.description_handle(i), source.weight(i), calories[i]);
+		}
+	}
+
+	return FilteredFoodTable;
+}
+
+
+// Greedy kernels over contiguous columns.
+// food_densities_* set densities[i] = calories[i] / weights[i]. The
+// find_fitting_food_* functions return the first k in [begin, end) where
+// capacity + weights[order[k]] <= total_weight, or end if there is none:
+// the next item the skip phase takes. The vector versions handle a block
+// of 4 (AVX2) or 8 (AVX-512) items per instruction, loading weights with
+// gathers, and finish the tail with the scalar loop. Vector division,
+// addition, and comparison round exactly as the scalar operations do, so
+// every version gives the same result.
+
+void food_densities_scalar(const double* calories, const double* weights, size_t n, double* densities)
+{
+	for (size_t i = 0; i < n; i++)
+	{
+		densities[i] = calories[i] / weights[i];
+	}
+}
+
+size_t find_fitting_food_scalar(const double* weights, const uint32_t* order, size_t begin, size_t end,
+	double capacity, double total_weight)
+{
+	for (size_t k = begin; k < end; k++)
+	{
+		if ( capacity + weights[order[k]] <= total_weight )
+		{
+			return k;
+		}
+	}
+	return end;
+}
+
+
+#ifdef MAXCALORIE_X86
+
+__attribute__((target("avx2")))
+void food_densities_avx2(const double* calories, const double* weights, size_t n, double* densities)
+{
+	size_t i = 0;
+	for ( ; i + 4 <= n; i += 4)
+	{
+		_mm256_storeu_pd(densities + i, _mm256_div_pd(_mm256_loadu_pd(calories + i), _mm256_loadu_pd(weights + i)));
+	}
+	food_densities_scalar(calories + i, weights + i, n - i, densities + i);
+}
+
+__attribute__((target("avx2")))
+size_t find_fitting_food_avx2(const double* weights, const uint32_t* order, size_t begin, size_t end,
+	double capacity, double total_weight)
+{
+	const __m256d capacity_v = _mm256_set1_pd(capacity);
+	const __m256d total_v = _mm256_set1_pd(total_weight);
+	const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+
+	size_t k = begin;
+	for ( ; k + 4 <= end; k += 4)
+	{
+		__m128i indices = _mm_loadu_si128(reinterpret_cast<const __m128i*>(order + k));
+		__m256d gathered = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), weights, indices, all, 8);
+		__m256d sums = _mm256_add_pd(capacity_v, gathered);
+		int mask = _mm256_movemask_pd(_mm256_cmp_pd(sums, total_v, _CMP_LE_OQ));
+		if ( mask )
+		{
+			return k + __builtin_ctz(mask);
+		}
+	}
+	return find_fitting_food_scalar(weights, order, k, end, capacity, total_weight);
+}
+
+__attribute__((target("avx512f")))
+void food_densities_avx512(const double* calories, const double* weights, size_t n, double* densities)
+{
+	size_t i = 0;
+	for ( ; i + 8 <= n; i += 8)
+	{
+		_mm512_storeu_pd(densities + i, _mm512_div_pd(_mm512_loadu_pd(calories + i), _mm512_loadu_pd(weights + i)));
+	}
+	food_densities_scalar(calories + i, weights + i, n - i, densities + i);
+}
+
+__attribute__((target("avx512f")))
+size_t find_fitting_food_avx512(const double* weights, const uint32_t* order, size_t begin, size_t end,
+	double capacity, double total_weight)
+{
+	const __m512d capacity_v = _mm512_set1_pd(capacity);
+	const __m512d total_v = _mm512_set1_pd(total_weight);
+
+	size_t k = begin;
+	for ( ; k + 8 <= end; k += 8)
+	{
+		__m256i indices = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(order + k));
+		__m512d gathered = _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xff, indices, weights, 8);
+		__m512d sums = _mm512_add_pd(capacity_v, gathered);
+		unsigned mask = _mm512_cmp_pd_mask(sums, total_v, _CMP_LE_OQ);
+		if ( mask )
+		{
+			return k + __builtin_ctz(mask);
+		}
+	}
+	return find_fitting_food_scalar(weights, order, k, end, capacity, total_weight);
+}
+
+#endif
+
+
+// The widest food_densities kernel the CPU supports.
+void food_densities(const double* calories, const double* weights, size_t n, double* densities)
+{
+#ifdef MAXCALORIE_X86
+	if ( cpu_has_avx512f() )
+	{
+		food_densities_avx512(calories, weights, n, densities);
+		return;
+	}
+	if ( cpu_has_avx2() )
+	{
+		food_densities_avx2(calories, weights, n, densities);
+		return;
+	}
+#endif
+	food_densities_scalar(calories, weights, n, densities);
+}
+
+// The widest find_fitting_food kernel the CPU supports. The gathers take
+// signed 32-bit indices, so longer columns use the scalar loop.
+size_t find_fitting_food(const double* weights, const uint32_t* order, size_t begin, size_t end,
+	double capacity, double total_weight, size_t column_size)
+{
+#ifdef MAXCALORIE_X86
+	if ( column_size <= size_t(INT32_MAX) )
+	{
+		if ( cpu_has_avx512f() )
+		{
+			return find_fitting_food_avx512(weights, order, begin, end, capacity, total_weight);
+		}
+		if ( cpu_has_avx2() )
+		{
+			return find_fitting_food_avx2(weights, order, begin, end, capacity, total_weight);
+		}
+	}
+#endif
+	return find_fitting_food_scalar(weights, order, begin, end, capacity, total_weight);
+}
+
+
+// The order of rows in greedy order: greater calories-per-weight first,
+// equal calories-per-weight in row order. For integer columns the
+// densities are compared exactly, by cross-multiplying.
+template <typename Number>
+std::vector<uint32_t> food_table_density_order(const BasicFoodTable<Number>& foods)
+{
+	const Number* weights = foods.weights();
+	const Number* calories = foods.calories();
+	size_t n = foods.size();
+	std::vector<uint32_t> order(n);
+
+	if constexpr ( std::is_same<Number, double>::value )
+	{
+		std::vector<double> densities(n);
+		food_densities(calories, weights, n, densities.data());
+		std::vector<DensityKey> keys(n);
+		for (size_t i = 0; i < n; i++)
+		{
+			keys[i] = { densities[i], uint32_t(i) };
+		}
+		sort_density_keys(keys);
+		for (size_t i = 0; i < n; i++)
+		{
+			order[i] = keys[i].index;
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			order[i] = uint32_t(i);
+		}
+		std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+		{
+			__int128 left = __int128(calories[a]) * weights[b];
+			__int128 right = __int128(calories[b]) * weights[a];
+			return left > right || (left == right && a < b);
+		});
+	}
+
+	return order;
+}
+
+
+// Build the density index of a table, with exact running totals for
+// integer columns.
+template <typename Number>
+BasicDensityIndex<Number> build_density_index(const BasicFoodTable<Number>& foods)
+{
+	BasicDensityIndex<Number> index;
+	index.order = food_table_density_order(foods);
+	index.sum_prefixes(
+		[&](uint32_t i) { return foods.weight(i); },
+		[&](uint32_t i) { return foods.foodCalories(i); }
+	);
+	return index;
+}
+
+
+// greedy_max_calories for a table; total_weight is in the table's units.
+// Ties in calories-per-weight are taken in table order. The table's
+// density index is built on the first call and reused afterwards, so
+// later calls do not sort. The result shares foods' DescriptionStore.
+template <typename Number>
+std::unique_ptr<BasicFoodTable<Number>> greedy_max_calories
+(
+	const BasicFoodTable<Number>& foods,
+	typename BasicFoodTable<Number>::value_type total_weight
+)
+{
+	const Number* weights = foods.weights();
+	const Number* calories = foods.calories();
+
+	const BasicDensityIndex<Number>& index = foods.density_index();
+
+	std::unique_ptr<BasicFoodTable<Number>> GreedyFoodTable(new BasicFoodTable<Number>(foods.shared_descriptions()));
+	size_t taken = index.critical_position(total_weight);
+	for (size_t k = 0; k < taken; k++)
+	{
+		uint32_t i = index.order[k];
+		GreedyFoodTable->push_back(foods.description_handle(i), weights[i], calories[i]);
+	}
+
+	Number capacity = index.prefix_weight[taken];
+	if constexpr ( std::is_same<Number, double>::value )
+	{
+		for (size_t k = taken; ; k++)
+		{
+			k = find_fitting_food(weights, index.order.data(), k, index.size(), capacity, total_weight, foods.size());
+			if ( k == index.size() )
+			{
+				break;
+			}
+			uint32_t i = index.order[k];
+			capacity += weights[i];
+			GreedyFoodTable->push_back(foods.description_handle(i), weights[i], calories[i]);
+		}
+	}
+	else
+	{
+		for (size_t k = taken; k < index.size(); k++)
+		{
+			uint32_t i = index.order[k];
+			if ( capacity + weights[i] <= total_weight )
+			{
+				capacity += weights[i];
+				GreedyFoodTable->push_back(foods.description_handle(i), weights[i], calories[i]);
+			}
+		}
+	}
+
+	return GreedyFoodTable;
+}
+
+
+// exhaustive_max_calories for a table, with the same result; total_weight
+// is in the table's units. Each subset is a bit mask over the rows, so no
+// candidate vectors are built. The result shares foods' DescriptionStore.
+template <typename Number>
+std::unique_ptr<BasicFoodTable<Number>> exhaustive_max_calories
+(
+	const BasicFoodTable<Number>& foods,
+	typename BasicFoodTable<Number>::value_type total_weight
+)
+{
+	size_t n = foods.size();
+	assert(n < 64);
+
+	const Number* weights = foods.weights();
+	const Number* calories = foods.calories();
+
+	uint64_t best_subset = exhaustive_best_subset(
+		n, total_weight,
+		[&](size_t j) { return weights[j]; },
+		[&](size_t j) { return calories[j]; }
+	);
+
+	std::unique_ptr<BasicFoodTable<Number>> BestFoodTable(new BasicFoodTable<Number>(foods.shared_descriptions()));
+	for (size_t j = 0; j < n; j++)
+	{
+		if ( (best_subset >> j) & 1 )
+		{
+			BestFoodTable->push_back(foods.description_handle(j), weights[j], calories[j]);
+		}
+	}
+	return BestFoodTable;
+}
+
+
+// Identifies an item in a DynamicFoodInventory. Ids are handed out in
+// increasing order, so they also record insertion order.
+typedef uint64_t FoodInventoryId;
+
+
+// A food inventory that changes one item at a time, kept in greedy order
+// so greedy queries need no sort. Items live in a treap ordered by
+// decreasing calories-per-weight, equal calories-per-weight by id. Each
+// node also holds its subtree's item count, total weight, total calories,
+// and least and greatest weight. insert and remove take expected
+// O(log n).
+// Greedy over the inventory gives the same selection as
+// greedy_max_calories over to_food_vector(), which lists the items in
+// insertion order.
+class DynamicFoodInventory
+{
+	//
+	public:
+
+		//
+		FoodInventoryId insert(std::shared_ptr<FoodItem> food)
+		{
+			FoodInventoryId id = _next_id++;
+			uint32_t node = allocate_node(std::move(food), id);
+			_percent[id] = _nodes[node].percent;
+
+			uint32_t before, after;
+			split(_root, _nodes[node].percent, id, before, after);
+			_root = merge(merge(before, node), after);
+			return id;
+		}
+
+		// Returns false if id is not in the inventory.
+		bool remove(FoodInventoryId id)
+		{
+			auto found = _percent.find(id);
+			if ( found == _percent.end() )
+			{
+				return false;
+			}
+			double percent = found->second;
+			_percent.erase(found);
+
+			uint32_t before, rest, item, after;
+			split(_root, percent, id, before, rest);
+			split(rest, percent, id + 1, item, after);
+			assert(item != NIL && _nodes[item].id == id);
+			_nodes[item].food.reset();
+			_free.push_back(item);
+			_root = merge(before, after);
+			return true;
+		}
+
+		//
+		size_t size() const { return count(_root); }
+		bool empty() const { return _root == NIL; }
+		double total_weight() const { return _root == NIL ? 0 : _nodes[_root].sum_weight; }
+		double total_calories() const { return _root == NIL ? 0 : _nodes[_root].sum_calories; }
+
+		// Call visit(food) for each item greedy takes within total_weight,
+		// in the order it takes them. Subtrees whose lightest item no longer
+		// fits are skipped whole, so a query visits the taken items and
+		// O(log n) nodes around each item taken after the first skip.
+		template <typename Visit>
+		void visit_greedy(double total_weight, Visit&& visit) const
+		{
+			double capacity = 0;
+			visit_greedy(_root, total_weight, capacity, visit);
+		}
+
+		// The fractional (Dantzig) bound for total_weight. As in
+		// greedy_max_calories_approximation, only items that fit on their
+		// own and have positive calories are considered, so this is that
+		// function's upper_bound. Found from the subtree sums in O(log n),
+		// plus O(log n) for each item heavier than total_weight that comes
+		// before the critical item in greedy order.
+		double fractional_bound(double total_weight) const
+		{
+			double bound = 0, remaining = total_weight;
+			fractional_bound(_root, total_weight, remaining, bound);
+			return bound;
+		}
+
+		// The items in insertion order.
+		std::unique_ptr<FoodVector> to_food_vector() const
+		{
+			std::vector<std::pair<FoodInventoryId, uint32_t>> ids;
+			ids.reserve(size());
+			for (uint32_t t = 0; t < _nodes.size(); t++)
+			{
+				if ( _nodes[t].food )
+				{
+					ids.emplace_back(_nodes[t].id, t);
+				}
+			}
+			std::sort(ids.begin(), ids.end());
+
+			std::unique_ptr<FoodVector> foods(new FoodVector);
+			foods->reserve(ids.size());
+			for (auto& entry : ids)
+			{
+				foods->push_back(_nodes[entry.second].food);
+			}
+			return foods;
+		}
+
+	//
+	private:
+
+		static constexpr uint32_t NIL = UINT32_MAX;
+
+		struct Node
+		{
+			std::shared_ptr<FoodItem> food;
+			double percent;
+			FoodInventoryId id;
+			uint64_t priority;
+			uint32_t left, right;
+			size_t count;
+			double sum_weight, sum_calories, min_weight, max_weight;
+		};
+
+		// True when the item of node t comes before (percent, id) in greedy
+		// order.
+		bool before(uint32_t t, double percent, FoodInventoryId id) const
+		{
+			const Node& node = _nodes[t];
+			return node.percent > percent || (node.percent == percent && node.id < id);
+		}
+
+		size_t count(uint32_t t) const { return t == NIL ? 0 : _nodes[t].count; }
+		double weight(uint32_t t) const { return t == NIL ? 0 : _nodes[t].sum_weight; }
+		double calories(uint32_t t) const { return t == NIL ? 0 : _nodes[t].sum_calories; }
+
+		uint32_t allocate_node(std::shared_ptr<FoodItem> food, FoodInventoryId id)
+		{
+			uint32_t t;
+			if ( _free.empty() )
+			{
+				t = uint32_t(_nodes.size());
+				_nodes.emplace_back();
+			}
+			else
+			{
+				t = _free.back();
+				_free.pop_back();
+			}
+
+			// splitmix64 of the id: deterministic, and independent of order.
+			uint64_t z = id + 0x9e3779b97f4a7c15ULL;
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+
+			Node& node = _nodes[t];
+			node.percent = food->foodCalories() / food->weight();
+			node.food = std::move(food);
+			node.id = id;
+			node.priority = z ^ (z >> 31);
+			node.left = node.right = NIL;
+			update(t);
+			return t;
+		}
+
+		void update(uint32_t t)
+		{
+			Node& node = _nodes[t];
+			node.count = 1 + count(node.left) + count(node.right);
+			node.sum_weight = weight(node.left) + node.food->weight() + weight(node.right);
+			node.sum_calories = calories(node.left) + node.food->foodCalories() + calories(node.right);
+			node.min_weight = node.max_weight = node.food->weight();
+			for (uint32_t child : { node.left, node.right })
+			{
+				if ( child != NIL )
+				{
+					node.min_weight = std::min(node.min_weight, _nodes[child].min_weight);
+					node.max_weight = std::max(node.max_weight, _nodes[child].max_weight);
+				}
+			}
+		}
+
+		// Split t into the items before (percent, id) and the rest.
+		void split(uint32_t t, double percent, FoodInventoryId id, uint32_t& before_key, uint32_t& rest)
+		{
+			if ( t == NIL )
+			{
+				before_key = rest = NIL;
+			}
+			else if ( before(t, percent, id) )
+			{
+				split(_nodes[t].right, percent, id, _nodes[t].right, rest);
+				before_key = t;
+				update(t);
+			}
+			else
+			{
+				split(_nodes[t].left, percent, id, before_key, _nodes[t].left);
+				rest = t;
+				update(t);
+			}
+		}
+
+		// Join two treaps, every item of a before every item of b.
+		uint32_t merge(uint32_t a, uint32_t b)
+		{
+			if ( a == NIL )
+			{
+				return b;
+			}
+			if ( b == NIL )
+			{
+				return a;
+			}
+			if ( _nodes[a].priority > _nodes[b].priority )
+			{
+				_nodes[a].right = merge(_nodes[a].right, b);
+				update(a);
+				return a;
+			}
+			_nodes[b].left = merge(a, _nodes[b].left);
+			update(b);
+			return b;
+		}
+
+		template <typename Visit>
+		void visit_greedy(uint32_t t, double total_weight, double& capacity, Visit& visit) const
+		{
+			// capacity only grows, so if the lightest item does not fit now
+			// none of the subtree ever will.
+			if ( t == NIL || capacity + _nodes[t].min_weight > total_weight )
+			{
+				return;
+			}
+			const Node& node = _nodes[t];
+			visit_greedy(node.left, total_weight, capacity, visit);
+			if ( capacity + node.food->weight() <= total_weight )
+			{
+				capacity += node.food->weight();
+				visit(node.food);
+			}
+			visit_greedy(node.right, total_weight, capacity, visit);
+		}
+
+		// Add the items of t that fit within total_weight on their own, in
+		// greedy order, to bound until remaining runs out. Returns true once
+		// it has, that is once the critical item has been added fractionally.
+		bool fractional_bound(uint32_t t, double total_weight, double& remaining, double& bound) const
+		{
+			if ( remaining <= 0 )
+			{
+				return true;
+			}
+			if ( t == NIL )
+			{
+				return false;
+			}
+			const Node& node = _nodes[t];
+			// Items after a non-positive one in greedy order are non-positive
+			// too.
+			if ( node.percent <= 0 )
+			{
+				return fractional_bound(node.left, total_weight, remaining, bound);
+			}
+
+			// node's calories are positive, so so are those of the items before
+			// it; take the whole left subtree at once if every item fits.
+			if ( node.left != NIL && _nodes[node.left].max_weight <= total_weight && weight(node.left) < remaining )
+			{
+				remaining -= weight(node.left);
+				bound += calories(node.left);
+			}
+			else if ( fractional_bound(node.left, total_weight, remaining, bound) )
+			{
+				return true;
+			}
+
+			if ( node.food->weight() <= total_weight )
+			{
+				if ( node.food->weight() >= remaining )
+				{
+					bound += remaining * node.percent;
+					return true;
+				}
+				remaining -= node.food->weight();
+				bound += node.food->foodCalories();
+			}
+			return fractional_bound(node.right, total_weight, remaining, bound);
+		}
+
+		std::vector<Node> _nodes;
+		std::vector<uint32_t> _free;
+		std::unordered_map<FoodInventoryId, double> _percent;
+		uint32_t _root = NIL;
+		FoodInventoryId _next_id = 0;
+};
+
+
+// greedy_max_calories for the current items of inventory, in the order
+// greedy takes them. The result shares the inventory's items.
+std::unique_ptr<FoodVector> greedy_max_calories
+(
+	const DynamicFoodInventory& inventory,
+	double total_weight
+)
+{
+	std::unique_ptr<FoodVector> GreedyFoodVector(new FoodVector);
+	inventory.visit_greedy(total_weight, [&](const std::shared_ptr<FoodItem>& food)
+	{
+		GreedyFoodVector->push_back(food);
+	});
+	return GreedyFoodVector;
+}
@@ -0,0 +1,447 @@
+///////////////////////////////////////////////////////////////////////////////
+// maxcalorie_benchmark.cc
+//
+// Micro-benchmarks for the hot paths in maxcalorie.hh.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "maxcalorie.hh"
+#include "food_generator.hh"
+#include "timer.hh"
+
+using namespace std;
+
+// The numeric field parser load_food_database used before
+// parse_food_double: one std::stringstream per field.
+bool parse_dbl_stringstream(const string& field, double& output)
+{
+  stringstream ss(field);
+  if ( ! ss )
+  {
+    return false;
+  }
+  ss >> output;
+  return true;
+}
+
+// Time parsing every weight and calorie field of food.csv, repeated
+// rounds times, with both parsers.
+void benchmark_field_parse(const string& path, int rounds)
+{
+  MappedFile file(path);
+  if ( ! file.is_open() )
+  {
+    cout << "Cannot open " << path << endl;
+    return;
+  }
+
+  vector<string> fields;
+  vector<string_view> views;
+  string_view text(file.data(), file.size());
+  bool header = true;
+  while ( ! text.empty() )
+  {
+    size_t newline = text.find('\n');
+    string_view line = text.substr(0, newline);
+    text.remove_prefix(newline == string_view::npos ? text.size() : newline + 1);
+    if ( header )
+    {
+      header = false;
+      continue;
+    }
+    string_view parts[3];
+    if ( split_food_line(line, parts, 3) == 3 )
+    {
+      fields.emplace_back(parts[1]);
+      fields.emplace_back(parts[2]);
+    }
+  }
+  for ( auto& field : fields )
+  {
+    views.push_back(field);
+  }
+
+  double sink = 0, value = 0;
+
+  Timer timer;
+  for ( int r = 0; r < rounds; r++ )
+  {
+    for ( auto& field : fields )
+    {
+      parse_dbl_stringstream(field, value);
+      sink += value;
+    }
+  }
+  double stringstream_seconds = timer.elapsed();
+
+  timer.reset();
+  for ( int r = 0; r < rounds; r++ )
+  {
+    for ( auto& field : views )
+    {
+      parse_food_double(field, value);
+      sink += value;
+    }
+  }
+  double from_chars_seconds = timer.elapsed();
+
+  double total = double(fields.size()) * rounds;
+  cout << fixed << setprecision(1)
+       << "field parse (" << fields.size() << " fields x " << rounds << ")" << endl
+       << "  stringstream:      " << total / stringstream_seconds / 1e6 << " M fields/s" << endl
+       << "  parse_food_double: " << total / from_chars_seconds / 1e6 << " M fields/s" << endl
+       << "  (checksum " << sink << ")" << endl;
+}
+
+// Time whole-file loads of path with each FoodLoadMode.
+void benchmark_load(const string& path, int rounds)
+{
+  cout << fixed << setprecision(2) << "load " << path << " (x " << rounds << ")" << endl;
+  for ( auto mode : { FoodLoadMode::stream, FoodLoadMode::mapped, FoodLoadMode::parallel } )
+  {
+    size_t rows = 0;
+    Timer timer;
+    for ( int r = 0; r < rounds; r++ )
+    {
+      auto foods = load_food_database(path, mode);
+      rows += foods ? foods->size() : 0;
+    }
+    cout << "  " << (mode == FoodLoadMode::stream ? "stream:   " : mode == FoodLoadMode::mapped ? "mapped:   " : "parallel: ")
+         << timer.elapsed() * 1000 / rounds << " ms per load (" << rows / rounds << " rows)" << endl;
+  }
+
+  {
+    size_t rows = 0;
+    Timer timer;
+    for ( int r = 0; r < rounds; r++ )
+    {
+      FoodArena arena;
+      auto foods = load_food_database(path, arena);
+      rows += foods ? foods->size() : 0;
+    }
+    cout << "  arena:    " << timer.elapsed() * 1000 / rounds << " ms per load (" << rows / rounds << " rows)" << endl;
+  }
+
+  string snapshot_path = path + ".snapshot";
+  auto foods = load_food_database(path, FoodLoadMode::mapped);
+  if ( foods && save_food_snapshot(*foods, snapshot_path, path) )
+  {
+    size_t rows = 0;
+    Timer timer;
+    for ( int r = 0; r < rounds; r++ )
+    {
+      auto snapshot = FoodSnapshot::open(snapshot_path, path);
+      rows += snapshot ? snapshot->size() : 0;
+    }
+    cout << "  snapshot: " << timer.elapsed() * 1000 / rounds << " ms per open (" << rows / rounds << " rows)" << endl;
+    remove(snapshot_path.c_str());
+  }
+}
+
+// Compare the memory held by FoodItem description strings with the
+// same descriptions in a DescriptionStore.
+void benchmark_description_memory(const string& path)
+{
+  auto foods = load_food_database(path, FoodLoadMode::mapped);
+  if ( ! foods )
+  {
+    return;
+  }
+
+  DescriptionStore store;
+  vector<DescriptionHandle> handles;
+  size_t string_bytes = 0;
+  for ( auto& food : *foods )
+  {
+    const string& description = food->description();
+    string_bytes += sizeof(string) + (description.capacity() > 15 ? description.capacity() + 1 : 0);
+    handles.push_back(store.add(description));
+  }
+  size_t store_bytes = store.memory_bytes() + handles.size() * sizeof(DescriptionHandle);
+
+  cout << "descriptions (" << foods->size() << " rows, " << store.size() << " distinct, "
+       << store.token_count() << " words)" << endl
+       << "  std::string:      " << string_bytes / 1024 << " KiB" << endl
+       << "  DescriptionStore: " << store_bytes / 1024 << " KiB" << endl;
+}
+
+// Time sum, filter and greedy over a FoodVector and over a FoodTable
+// holding the rows of path repeated copies times.
+void benchmark_table(const string& path, int copies)
+{
+  auto foods = load_food_database(path, FoodLoadMode::mapped);
+  if ( ! foods )
+  {
+    return;
+  }
+  FoodVector big;
+  for ( int c = 0; c < copies; c++ )
+  {
+    for ( auto& food : *foods )
+    {
+      big.push_back(make_shared<FoodItem>(*food));
+    }
+  }
+  auto table = make_food_table(big);
+
+  double weight, calories, sink = 0;
+  cout << fixed << setprecision(2) << "FoodVector vs FoodTable (" << big.size() << " rows)" << endl;
+
+  Timer timer;
+  for ( int r = 0; r < 10; r++ )
+  {
+    sum_food_vector(big, weight, calories);
+    sink += weight;
+  }
+  double vector_sum = timer.elapsed() / 10;
+  timer.reset();
+  for ( int r = 0; r < 10; r++ )
+  {
+    sum_food_table(*table, weight, calories);
+    sink += weight;
+  }
+  double table_sum = timer.elapsed() / 10;
+  cout << "  sum:    " << vector_sum * 1000 << " ms vs " << table_sum * 1000 << " ms (checksum " << sink << ")" << endl;
+
+  timer.reset();
+  auto filtered_vector = filter_food_vector(big, 100, 500, int(big.size()));
+  double vector_filter = timer.elapsed();
+  timer.reset();
+  auto filtered_table = filter_food_table(*table, 100, 500, int(big.size()));
+  double table_filter = timer.elapsed();
+  cout << "  filter: " << vector_filter * 1000 << " ms vs " << table_filter * 1000 << " ms" << endl;
+
+  timer.reset();
+  auto greedy_vector = greedy_max_calories(big, 5000);
+  double vector_greedy = timer.elapsed();
+  timer.reset();
+  auto greedy_table = greedy_max_calories(*table, 5000);
+  double table_greedy = timer.elapsed();
+  cout << "  greedy: " << vector_greedy * 1000 << " ms vs " << table_greedy * 1000 << " ms" << endl;
+}
+
+// The greedy_max_calories sort before DensityKey: every key holds a copy
+// of its FoodItem, and the comparator takes its arguments by value.
+struct CopiedPercentItem
+{
+  double percent;
+  FoodItem item;
+};
+
+size_t greedy_copying(const FoodVector& foods, double total_weight)
+{
+  vector<CopiedPercentItem> items;
+  for ( auto& food : foods )
+  {
+    items.push_back({ food->foodCalories() / food->weight(), *food });
+  }
+  sort(items.begin(), items.end(),
+       [](const CopiedPercentItem a, const CopiedPercentItem b) { return a.percent > b.percent; });
+
+  FoodVector chosen;
+  double capacity = 0;
+  for ( auto& entry : items )
+  {
+    if ( capacity + entry.item.weight() <= total_weight )
+    {
+      capacity += entry.item.weight();
+      chosen.push_back(make_shared<FoodItem>(entry.item));
+    }
+  }
+  return chosen.size();
+}
+
+// Time greedy_max_calories against the copying sort it replaced, on the
+// rows of path repeated copies times.
+void benchmark_greedy(const string& path, int copies)
+{
+  auto foods = load_food_database(path, FoodLoadMode::mapped);
+  if ( ! foods )
+  {
+    return;
+  }
+  FoodVector big;
+  for ( int c = 0; c < copies; c++ )
+  {
+    big.insert(big.end(), foods->begin(), foods->end());
+  }
+
+  cout << fixed << setprecision(2) << "greedy (" << big.size() << " rows)" << endl;
+  Timer timer;
+  size_t copied = greedy_copying(big, 50000);
+  double copying = timer.elapsed();
+  timer.reset();
+  size_t keyed = greedy_max_calories(big, 50000)->size();
+  double keys = timer.elapsed();
+  cout << "  copying items:   " << copying * 1000 << " ms (" << copied << " chosen)" << endl
+       << "  density keys:    " << keys * 1000 << " ms (" << keyed << " chosen)" << endl;
+
+  for ( double total_weight : { 5000.0, 500000.0, 50000000.0 } )
+  {
+    timer.reset();
+    size_t full = greedy_max_calories_selection(big, total_weight).size();
+    double full_time = timer.elapsed();
+    timer.reset();
+    size_t partial = greedy_max_calories_partial_selection(big, total_weight).size();
+    double partial_time = timer.elapsed();
+    cout << "  W = " << total_weight << ": full sort " << full_time * 1000 << " ms vs partial "
+         << partial_time * 1000 << " ms (" << full << " / " << partial << " chosen)" << endl;
+  }
+
+  timer.reset();
+  size_t parallel = greedy_max_calories_parallel_selection(big, 50000).size();
+  cout << "  parallel (" << thread::hardware_concurrency() << " threads): "
+       << timer.elapsed() * 1000 << " ms (" << parallel << " chosen)" << endl;
+
+  timer.reset();
+  double sorted_bound = greedy_max_calories_approximation(big, 50000).upper_bound;
+  double sorted_time = timer.elapsed();
+  timer.reset();
+  double selected_bound = find_critical_item(big, 50000).fractional_bound;
+  cout << "  Dantzig bound: sorting " << sorted_time * 1000 << " ms vs critical item selection "
+       << timer.elapsed() * 1000 << " ms (" << sorted_bound << " / " << selected_bound << ")" << endl;
+
+  timer.reset();
+  DynamicFoodInventory inventory;
+  for ( auto& food : big )
+  {
+    inventory.insert(food);
+  }
+  double insert_time = timer.elapsed();
+  timer.reset();
+  size_t dynamic = greedy_max_calories(inventory, 50000)->size();
+  cout << "  DynamicFoodInventory: " << insert_time * 1e9 / big.size() << " ns per insert, greedy "
+       << timer.elapsed() * 1000 << " ms (" << dynamic << " chosen)" << endl;
+
+  for ( int budget_us : { 100, 1000, 10000 } )
+  {
+    auto start = greedy_max_calories_selection(*foods, 5000);
+    timer.reset();
+    auto improved = improve_food_selection(start, 5000, chrono::microseconds(budget_us));
+    double improve_time = timer.elapsed();
+    double start_weight, start_calories;
+    sum_food_selection(start, start_weight, start_calories);
+    cout << "  local search, " << budget_us << " us budget: " << start_calories << " -> " << improved.calories
+         << " calories in " << improve_time * 1e6 << " us (" << improved.moves << " moves"
+         << (improved.converged ? ", converged" : "") << ")" << endl;
+  }
+}
+
+// Time the scalar and dispatched greedy kernels on a FoodTable holding
+// the rows of path repeated copies times.
+void benchmark_kernels(const string& path, int copies)
+{
+  auto foods = load_food_database(path, FoodLoadMode::mapped);
+  if ( ! foods )
+  {
+    return;
+  }
+  FoodVector big;
+  for ( int c = 0; c < copies; c++ )
+  {
+    big.insert(big.end(), foods->begin(), foods->end());
+  }
+  auto table = make_food_table(big);
+  size_t n = table->size();
+  const vector<uint32_t>& order = table->density_index().order;
+  vector<double> densities(n);
+
+  cout << fixed << setprecision(3) << "greedy kernels (" << n << " rows, "
+       << (cpu_has_avx512f() ? "AVX-512" : cpu_has_avx2() ? "AVX2" : "scalar") << ")" << endl;
+
+  Timer timer;
+  for ( int r = 0; r < 10; r++ )
+  {
+    food_densities_scalar(table->calories(), table->weights(), n, densities.data());
+  }
+  double scalar = timer.elapsed() / 10;
+  timer.reset();
+  for ( int r = 0; r < 10; r++ )
+  {
+    food_densities(table->calories(), table->weights(), n, densities.data());
+  }
+  double vector = timer.elapsed() / 10;
+  cout << "  densities: " << scalar * 1000 << " ms vs " << vector * 1000 << " ms" << endl;
+
+  // A skip phase that takes nothing scans the whole order.
+  timer.reset();
+  size_t k = find_fitting_food_scalar(table->weights(), order.data(), 0, n, 0, 1);
+  scalar = timer.elapsed();
+  timer.reset();
+  k += find_fitting_food(table->weights(), order.data(), 0, n, 0, 1, n);
+  vector = timer.elapsed();
+  cout << "  skip scan: " << scalar * 1000 << " ms vs " << vector * 1000 << " ms (" << k << ")" << endl;
+}
+
+// Time sorting DensityKeys of pantry-distributed items into greedy order
+// with std::sort and the sortPercentage comparison greedy_max_calories
+// used to have, std::sort with density_key_before, and
+// radix_sort_density_keys, for sizes from 1K up to max_size.
+void benchmark_density_sort(size_t max_size)
+{
+  cout << fixed << setprecision(3) << "density sort (ms): size, sortPercentage, density_key_before, radix" << endl;
+
+  FoodGenerator generator(FoodDistribution::pantry, 1);
+  vector<DensityKey> source;
+  string description;
+  FoodCenti weight, calories;
+  for ( size_t size = 1000; size <= max_size; size *= 10 )
+  {
+    for ( size_t i = source.size(); i < size; i++ )
+    {
+      generator.row(i, description, weight, calories);
+      source.push_back({ double(calories) / double(weight), uint32_t(i) });
+    }
+
+    int rounds = int(max<size_t>(1, 1000000 / size));
+    double elapsed[3] = { 0, 0, 0 };
+    for ( int r = 0; r < rounds; r++ )
+    {
+      vector<DensityKey> keys(source);
+      Timer timer;
+      sort(keys.begin(), keys.end(), [](const DensityKey a, const DensityKey b) { return a.percent > b.percent; });
+      elapsed[0] += timer.elapsed();
+
+      keys = source;
+      timer.reset();
+      sort(keys.begin(), keys.end(), density_key_before);
+      elapsed[1] += timer.elapsed();
+
+      keys = source;
+      timer.reset();
+      radix_sort_density_keys(keys);
+      elapsed[2] += timer.elapsed();
+    }
+    cout << "  " << setw(9) << size;
+    for ( double e : elapsed )
+    {
+      cout << setw(12) << e / rounds * 1000;
+    }
+    cout << endl;
+  }
+}
+
+// maxcalorie_benchmark [PATH [MAX_SORT_SIZE]]
+// PATH defaults to food.csv, MAX_SORT_SIZE to 10000000; sorting 100M keys
+// needs about 3.2 GB.
+int main(int argc, char* argv[])
+{
+  string path = argc > 1 ? argv[1] : "food.csv";
+  size_t max_sort_size = argc > 2 ? size_t(atoll(argv[2])) : 10000000;
+
+  benchmark_field_parse(path, 20);
+  benchmark_load(path, 10);
+  benchmark_description_memory(path);
+  benchmark_table(path, 64);
+  benchmark_greedy(path, 64);
+  benchmark_kernels(path, 64);
+  benchmark_density_sort(max_sort_size);
+
+  return 0;
+}
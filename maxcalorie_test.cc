@@ -11,6 +11,7 @@
 
 
 #include "maxcalorie.hh"
+#include "food_generator.hh"
 #include "rubrictest.hh"
 
 
@@ -36,7 +37,493 @@ int main()
 			TEST_EQUAL("size", 8064, all_foods->size());
 		}
 	);
-	
+
+	//
+	rubric.criterion(
+		"load_food_database mapped mode", 2,
+		[&]()
+		{
+			auto mapped = load_food_database("food.csv", FoodLoadMode::mapped);
+			TEST_TRUE("non-null", mapped);
+			TEST_EQUAL("size", all_foods->size(), mapped->size());
+			for (size_t i = 0; i < mapped->size(); i++) {
+				TEST_EQUAL("description", (*all_foods)[i]->description(), (*mapped)[i]->description());
+				TEST_EQUAL("weight", (*all_foods)[i]->weight(), (*mapped)[i]->weight());
+				TEST_EQUAL("calories", (*all_foods)[i]->foodCalories(), (*mapped)[i]->foodCalories());
+			}
+
+			// A trailing '^' adds no field, as in the stream loader.
+			const char* caret_path = "maxcalorie_test_caret.csv";
+			{
+				std::ofstream caret(caret_path);
+				caret << "Item^Weight^Calorie\nbeans^1^2^\nrice^3^4\ncorn^5^6^";
+			}
+			auto stream = load_food_database(caret_path, FoodLoadMode::stream);
+			TEST_TRUE("non-null", stream);
+			TEST_EQUAL("trailing caret", 3, stream->size());
+			auto same_as_stream = [&](const FoodVector& loaded) {
+				TEST_EQUAL("trailing caret", stream->size(), loaded.size());
+				for (size_t i = 0; i < std::min(stream->size(), loaded.size()); i++) {
+					TEST_EQUAL("description", (*stream)[i]->description(), loaded[i]->description());
+					TEST_EQUAL("calories", (*stream)[i]->foodCalories(), loaded[i]->foodCalories());
+				}
+			};
+			FoodArena arena;
+			FoodLoadReport report;
+			for (auto& loaded : { load_food_database(caret_path, FoodLoadMode::mapped),
+				load_food_database(caret_path, FoodLoadMode::parallel), load_food_database(caret_path, arena),
+				load_food_database(caret_path, report) }) {
+				TEST_TRUE("non-null", loaded);
+				same_as_stream(*loaded);
+			}
+			TEST_EQUAL("trailing caret", 0, report.rows_skipped);
+			IncrementalFoodDatabase tail(caret_path);
+			tail.refresh();
+			same_as_stream(tail.foods());
+			size_t visited = 0;
+			visit_food_database(caret_path, [&](std::string_view, double, double) { visited++; return true; });
+			TEST_EQUAL("trailing caret", stream->size(), visited);
+			TEST_EQUAL("trailing caret", stream->size(), load_food_table<double>(caret_path)->size());
+			std::remove(caret_path);
+		}
+	);
+
+	//
+	rubric.criterion(
+		"parse_food_double", 2,
+		[&]()
+		{
+			double value = -1;
+			TEST_TRUE("plain", parse_food_double("609.3", value));
+			TEST_EQUAL("plain", 609.3, value);
+			TEST_TRUE("CRLF", parse_food_double("481.1\r", value));
+			TEST_EQUAL("CRLF", 481.1, value);
+			TEST_TRUE("blanks", parse_food_double(" +12 ", value));
+			TEST_EQUAL("blanks", 12, value);
+			value = -1;
+			TEST_FALSE("empty", parse_food_double("", value));
+			TEST_FALSE("garbage", parse_food_double("abc", value));
+			TEST_FALSE("trailing garbage", parse_food_double("12oz", value));
+			TEST_FALSE("two signs", parse_food_double("+-5", value));
+			TEST_FALSE("two signs", parse_food_double("++5", value));
+			TEST_FALSE("not finite", parse_food_double("inf", value));
+			TEST_EQUAL("untouched on failure", -1, value);
+		}
+	);
+
+	//
+	rubric.criterion(
+		"scan_food_delimiters", 2,
+		[&]()
+		{
+			std::string text = "header^line\n";
+			for (int i = 0; i < 40; i++) {
+				text += std::string(i, 'x') + "^" + std::to_string(i) + "^" + std::to_string(i * 2) + "\r\n";
+			}
+			text += "^^\n\n^";
+
+			std::vector<const char*> expected, actual;
+			auto collect = [](std::vector<const char*>& out) { return [&out](const char* p) { out.push_back(p); }; };
+			scan_food_delimiters_scalar(text.data(), text.data() + text.size(), collect(expected));
+			scan_food_delimiters(text.data(), text.data() + text.size(), collect(actual));
+			TEST_EQUAL("same delimiters", expected, actual);
+#ifdef MAXCALORIE_X86
+			actual.clear();
+			scan_food_delimiters_sse2(text.data(), text.data() + text.size(), collect(actual));
+			TEST_EQUAL("sse2 delimiters", expected, actual);
+#endif
+
+			std::string good = "Item^Weight^Calorie\r\nbeans^1.5^2\r\nrice^x^3\r\ncorn^4^5";
+			std::vector<std::string> descriptions;
+			TEST_TRUE("parses", parse_food_rows(good.data(), good.data() + good.size(), 1,
+				[&](std::string_view d, double, double) { descriptions.emplace_back(d); }));
+			TEST_EQUAL("rows", 2, descriptions.size());
+			TEST_EQUAL("last row without newline", "corn", descriptions[1]);
+
+			std::string bad = "Item^Weight^Calorie\nbeans^1^2\n\ncorn^4^5\n";
+			TEST_FALSE("empty line", parse_food_rows(bad.data(), bad.data() + bad.size(), 1,
+				[&](std::string_view, double, double) { }));
+		}
+	);
+
+	//
+	rubric.criterion(
+		"load_food_database_parallel", 2,
+		[&]()
+		{
+			for (unsigned threads : { 1u, 2u, 3u, 8u }) {
+				auto parallel = load_food_database_parallel("food.csv", threads);
+				TEST_TRUE("non-null", parallel);
+				TEST_EQUAL("size", all_foods->size(), parallel->size());
+				for (size_t i = 0; i < parallel->size(); i++) {
+					TEST_EQUAL("row order", (*all_foods)[i]->description(), (*parallel)[i]->description());
+					TEST_EQUAL("row order", (*all_foods)[i]->weight(), (*parallel)[i]->weight());
+				}
+			}
+
+			// A bad line deep in the file reports its global line number.
+			const char* bad_path = "maxcalorie_test_bad.csv";
+			{
+				std::ofstream bad(bad_path);
+				bad << "Item^Weight^Calorie\n";
+				for (int line = 2; line <= 20000; line++) {
+					bad << (line == 15003 ? "broken^row" : "beans^1^2") << "\n";
+				}
+			}
+			std::stringstream messages;
+			auto saved = std::cout.rdbuf(messages.rdbuf());
+			auto failed = load_food_database_parallel(bad_path, 4);
+			std::cout.rdbuf(saved);
+			std::remove(bad_path);
+			TEST_FALSE("bad line", failed);
+			TEST_TRUE("line number", messages.str().find("at line 15003;") != std::string::npos);
+		}
+	);
+
+	//
+	rubric.criterion(
+		"error-collecting load_food_database", 2,
+		[&]()
+		{
+			FoodLoadReport report;
+			auto clean = load_food_database("food.csv", report);
+			TEST_TRUE("non-null", clean);
+			TEST_EQUAL("clean size", all_foods->size(), clean->size());
+			TEST_EQUAL("clean rows", all_foods->size(), report.rows_loaded);
+			TEST_EQUAL("clean skipped", 0, report.rows_skipped);
+
+			const char* bad_path = "maxcalorie_test_errors.csv";
+			{
+				std::ofstream bad(bad_path);
+				bad << "Item^Weight^Calorie\n"			// line 1, byte 0
+					<< "beans^1^2\n"			// line 2, byte 20
+					<< "broken row\n"			// line 3, byte 30
+					<< "rice^heavy^3\n"			// line 4, byte 41
+					<< "corn^4^lots\n"			// line 5, byte 54
+					<< "^5^6\n"				// line 6, byte 66
+					<< "peas^-1^6\n"			// line 7, byte 71
+					<< "\n"					// line 8, byte 81
+					<< "pasta^7^8";				// line 9, byte 82
+			}
+			auto foods = load_food_database(bad_path, report, 3);
+			std::remove(bad_path);
+			TEST_TRUE("non-null", foods);
+			TEST_EQUAL("good rows", 2, foods->size());
+			TEST_EQUAL("good rows", "pasta", (*foods)[1]->description());
+			TEST_EQUAL("rows_loaded", 2, report.rows_loaded);
+			TEST_EQUAL("rows_skipped", 6, report.rows_skipped);
+			TEST_EQUAL("field count", 2, report.skipped_by_error[int(FoodRowError::field_count)]);
+			TEST_EQUAL("weight", 2, report.skipped_by_error[int(FoodRowError::weight)]);
+			TEST_EQUAL("calories", 1, report.skipped_by_error[int(FoodRowError::calories)]);
+			TEST_EQUAL("description", 1, report.skipped_by_error[int(FoodRowError::description)]);
+			TEST_EQUAL("bounded", 3, report.diagnostics.size());
+			TEST_EQUAL("dropped", 3, report.diagnostics_dropped);
+			TEST_EQUAL("line", 3, report.diagnostics[0].line_number);
+			TEST_EQUAL("offset", 30, report.diagnostics[0].byte_offset);
+			TEST_TRUE("reason", FoodRowError::field_count == report.diagnostics[0].error);
+			TEST_EQUAL("line", 5, report.diagnostics[2].line_number);
+			TEST_EQUAL("offset", 54, report.diagnostics[2].byte_offset);
+			TEST_TRUE("reason", FoodRowError::calories == report.diagnostics[2].error);
+		}
+	);
+
+	//
+	rubric.criterion(
+		"IncrementalFoodDatabase", 2,
+		[&]()
+		{
+			const char* path = "maxcalorie_test_tail.csv";
+			std::filesystem::copy_file("food.csv", path, std::filesystem::copy_options::overwrite_existing);
+			auto append = [&](const std::string& text)
+			{
+				std::ofstream csv(path, std::ios::app | std::ios::binary);
+				csv << text;
+			};
+			auto same_as_full_load = [&](const IncrementalFoodDatabase& tail)
+			{
+				auto full = load_food_database(path, FoodLoadMode::mapped);
+				if ( ! full || full->size() != tail.foods().size() ) {
+					return false;
+				}
+				for (size_t i = 0; i < full->size(); i++) {
+					if ( (*full)[i]->description() != tail.foods()[i]->description()
+						|| (*full)[i]->weight() != tail.foods()[i]->weight()
+						|| (*full)[i]->foodCalories() != tail.foods()[i]->foodCalories() ) {
+						return false;
+					}
+				}
+				return true;
+			};
+
+			IncrementalFoodDatabase tail(path);
+			TEST_TRUE("first load", FoodRefresh::reloaded == tail.refresh());
+			TEST_EQUAL("size", all_foods->size(), tail.foods().size());
+			TEST_TRUE("no change", FoodRefresh::unchanged == tail.refresh());
+
+			// Completes food.csv's unterminated last line and adds another.
+			append("\r\nnew beans^10^20");
+			TEST_TRUE("appended", FoodRefresh::appended == tail.refresh());
+			TEST_EQUAL("size", all_foods->size() + 1, tail.foods().size());
+			TEST_TRUE("matches full load", same_as_full_load(tail));
+
+			// A line still being written is held back.
+			append("\nmore rice^1");
+			TEST_TRUE("appended", FoodRefresh::appended == tail.refresh());
+			TEST_EQUAL("partial line", all_foods->size() + 1, tail.foods().size());
+			append("5^30\n");
+			TEST_TRUE("appended", FoodRefresh::appended == tail.refresh());
+			TEST_EQUAL("line completed", all_foods->size() + 2, tail.foods().size());
+			TEST_EQUAL("line completed", 15, tail.foods().back()->weight());
+			TEST_TRUE("matches full load", same_as_full_load(tail));
+
+			// A bad complete line is skipped and recorded, and rows after it
+			// are still picked up, in the same refresh and in later ones.
+			append("broken\nbeans^-1^2\nafter beans^2^4\n");
+			TEST_TRUE("appended past bad lines", FoodRefresh::appended == tail.refresh());
+			TEST_EQUAL("good row kept", all_foods->size() + 3, tail.foods().size());
+			TEST_EQUAL("good row kept", "after beans", tail.foods().back()->description());
+			TEST_EQUAL("skipped", 2, tail.report().rows_skipped);
+			TEST_EQUAL("skipped", 1, tail.report().skipped_by_error[int(FoodRowError::field_count)]);
+			TEST_EQUAL("skipped", 1, tail.report().skipped_by_error[int(FoodRowError::weight)]);
+			TEST_EQUAL("line", all_foods->size() + 4, tail.report().diagnostics[0].line_number);
+			TEST_EQUAL("rows_loaded", tail.foods().size(), tail.report().rows_loaded);
+			append("later beans^3^6\n");
+			TEST_TRUE("appended after bad lines", FoodRefresh::appended == tail.refresh());
+			TEST_EQUAL("later row", "later beans", tail.foods().back()->description());
+			TEST_EQUAL("not skipped again", 2, tail.report().rows_skipped);
+
+			// Rewriting the file falls back to a full load.
+			{
+				std::ofstream csv(path, std::ios::trunc);
+				csv << "Item^Weight^Calorie\nbeans^1^2\n";
+			}
+			TEST_TRUE("reloaded", FoodRefresh::reloaded == tail.refresh());
+			TEST_EQUAL("rewritten", 1, tail.foods().size());
+			TEST_EQUAL("report reset", 0, tail.report().rows_skipped);
+			std::remove(path);
+		}
+	);
+
+	//
+	rubric.criterion(
+		"FoodArena", 2,
+		[&]()
+		{
+			FoodArena arena;
+			auto foods = load_food_database("food.csv", arena);
+			TEST_TRUE("non-null", foods);
+			TEST_EQUAL("size", all_foods->size(), foods->size());
+			TEST_EQUAL("arena items", all_foods->size(), arena.size());
+			for (size_t i = 0; i < foods->size(); i++) {
+				TEST_EQUAL("description", (*all_foods)[i]->description(), (*foods)[i]->description());
+				TEST_EQUAL("weight", (*all_foods)[i]->weight(), (*foods)[i]->weight());
+			}
+			TEST_EQUAL("no control block", 0, (*foods)[0].use_count());
+			TEST_EQUAL("contiguous", (*foods)[0].get() + 1, (*foods)[1].get());
+
+			// The FoodVector API works unchanged on arena items.
+			double expected_weight, expected_calories, weight, calories;
+			sum_food_vector(*greedy_max_calories(*filtered_foods, 5000), expected_weight, expected_calories);
+			auto arena_filtered = filter_food_vector(*foods, 1, 2500, foods->size());
+			sum_food_vector(*greedy_max_calories(*arena_filtered, 5000), weight, calories);
+			TEST_TRUE("greedy", std::abs(weight - expected_weight) < 1e-6);
+
+			MonotonicArena scratch;
+			auto expected = greedy_max_calories_selection(*filtered_foods, 5000);
+			size_t reserved = 0;
+			for (int round = 0; round < 3; round++) {
+				scratch.reset();
+				auto selection = greedy_max_calories_selection(*filtered_foods, 5000, scratch);
+				TEST_EQUAL("scratch greedy", expected.indices(), selection.indices());
+				if ( round == 0 ) {
+					reserved = scratch.bytes_reserved();
+				}
+				TEST_EQUAL("scratch reused", reserved, scratch.bytes_reserved());
+			}
+		}
+	);
+
+	//
+	rubric.criterion(
+		"food snapshot", 2,
+		[&]()
+		{
+			const char* csv_path = "maxcalorie_test_snapshot.csv";
+			const char* snapshot_path = "maxcalorie_test_snapshot.bin";
+			std::filesystem::copy_file("food.csv", csv_path, std::filesystem::copy_options::overwrite_existing);
+			std::remove(snapshot_path);
+
+			auto first = load_food_database_cached(csv_path, snapshot_path);
+			TEST_TRUE("non-null", first);
+			auto snapshot = FoodSnapshot::open(snapshot_path, csv_path);
+			TEST_TRUE("snapshot written", snapshot);
+			TEST_EQUAL("size", all_foods->size(), snapshot->size());
+			for (size_t i = 0; i < snapshot->size(); i++) {
+				TEST_EQUAL("description", (*all_foods)[i]->description(), snapshot->description(i));
+				TEST_EQUAL("weight", (*all_foods)[i]->weight(), snapshot->weight(i));
+				TEST_EQUAL("calories", (*all_foods)[i]->foodCalories(), snapshot->foodCalories(i));
+			}
+
+			// Appending to the CSV file makes the snapshot stale.
+			{
+				std::ofstream csv(csv_path, std::ios::app);
+				csv << "\r\nextra beans^10^20";
+			}
+			TEST_FALSE("stale", FoodSnapshot::open(snapshot_path, csv_path));
+			auto second = load_food_database_cached(csv_path, snapshot_path);
+			TEST_TRUE("non-null", second);
+			TEST_EQUAL("reloaded from CSV", all_foods->size() + 1, second->size());
+			TEST_TRUE("refreshed", FoodSnapshot::open(snapshot_path, csv_path));
+
+			// Damage is caught by the checksum.
+			{
+				std::fstream bin(snapshot_path, std::ios::in | std::ios::out | std::ios::binary);
+				bin.seekp(sizeof(FoodSnapshotHeader) + 3);
+				bin.put('\x7f');
+			}
+			TEST_FALSE("checksum", FoodSnapshot::open(snapshot_path, csv_path));
+
+			// So is damage to the header, and a header or offsets table that
+			// points outside the file is refused even with a matching
+			// checksum.
+			auto rewrite = [&](bool fix_checksum, std::function<void(FoodSnapshotHeader&, std::string&)> damage)
+			{
+				save_food_snapshot(*second, snapshot_path, csv_path);
+				std::string image;
+				{
+					std::ifstream bin(snapshot_path, std::ios::binary);
+					image.assign(std::istreambuf_iterator<char>(bin), std::istreambuf_iterator<char>());
+				}
+				FoodSnapshotHeader header;
+				std::memcpy(&header, image.data(), sizeof(header));
+				damage(header, image);
+				if ( fix_checksum ) {
+					header.checksum = food_snapshot_image_checksum(header, image.data() + sizeof(header), image.size() - sizeof(header));
+				}
+				std::memcpy(&image[0], &header, sizeof(header));
+				std::ofstream bin(snapshot_path, std::ios::binary | std::ios::trunc);
+				bin.write(image.data(), image.size());
+			};
+			rewrite(true, [](FoodSnapshotHeader&, std::string&) {});
+			TEST_TRUE("rewritten intact", FoodSnapshot::open(snapshot_path, csv_path));
+			rewrite(false, [](FoodSnapshotHeader& header, std::string&) { header.weights_offset += 8; });
+			TEST_FALSE("header checksum", FoodSnapshot::open(snapshot_path, csv_path));
+			rewrite(true, [](FoodSnapshotHeader& header, std::string&) { header.calories_offset = header.file_size - 8; });
+			TEST_FALSE("column past end", FoodSnapshot::open(snapshot_path, csv_path));
+			rewrite(true, [](FoodSnapshotHeader& header, std::string&) { header.weights_offset = UINT64_MAX - 7; });
+			TEST_FALSE("offset overflow", FoodSnapshot::open(snapshot_path, csv_path));
+			rewrite(true, [](FoodSnapshotHeader& header, std::string&) { header.row_count = UINT64_MAX / 8 + 2; });
+			TEST_FALSE("row count overflow", FoodSnapshot::open(snapshot_path, csv_path));
+			rewrite(true, [](FoodSnapshotHeader& header, std::string& image) {
+				uint64_t offset = 1000000;
+				std::memcpy(&image[header.description_offsets_offset + 8], &offset, sizeof(offset));
+			});
+			TEST_FALSE("description past end", FoodSnapshot::open(snapshot_path, csv_path));
+			rewrite(true, [](FoodSnapshotHeader& header, std::string& image) {
+				uint64_t offset = 1;
+				std::memcpy(&image[header.description_offsets_offset], &offset, sizeof(offset));
+			});
+			TEST_FALSE("first description offset", FoodSnapshot::open(snapshot_path, csv_path));
+			rewrite(true, [](FoodSnapshotHeader& header, std::string&) { header.descriptions_size -= 1; });
+			TEST_FALSE("descriptions end", FoodSnapshot::open(snapshot_path, csv_path));
+			rewrite(true, [](FoodSnapshotHeader& header, std::string&) { header.density_order_offset = header.file_size - 4; });
+			TEST_FALSE("density order past end", FoodSnapshot::open(snapshot_path, csv_path));
+			rewrite(true, [](FoodSnapshotHeader& header, std::string&) { header.density_order_offset = header.weights_offset; });
+			TEST_FALSE("density order over columns", FoodSnapshot::open(snapshot_path, csv_path));
+			rewrite(true, [](FoodSnapshotHeader& header, std::string&) { header.density_prefix_weight_offset = UINT64_MAX - 7; });
+			TEST_FALSE("density prefix overflow", FoodSnapshot::open(snapshot_path, csv_path));
+			rewrite(true, [](FoodSnapshotHeader& header, std::string& image) {
+				uint32_t row = uint32_t(header.row_count);
+				std::memcpy(&image[header.density_order_offset], &row, sizeof(row));
+			});
+			TEST_FALSE("density order entry", FoodSnapshot::open(snapshot_path, csv_path));
+
+			std::remove(csv_path);
+			std::remove(snapshot_path);
+		}
+	);
+
+	//
+	rubric.criterion(
+		"DescriptionStore", 2,
+		[&]()
+		{
+			DescriptionStore store;
+			std::vector<DescriptionHandle> handles;
+			for (auto& food : *all_foods) {
+				handles.push_back(store.add(food->description()));
+			}
+			TEST_EQUAL("dictionary", 37, store.token_count());
+			TEST_TRUE("interned", store.size() < all_foods->size());
+			for (size_t i = 0; i < all_foods->size(); i++) {
+				TEST_EQUAL("round trip", (*all_foods)[i]->description(), store.text(handles[i]));
+				TEST_EQUAL("equal text, equal handle", handles[i], store.add((*all_foods)[i]->description()));
+			}
+
+			DescriptionHandle odd = store.add(" two  spaces ");
+			TEST_EQUAL("exact spacing", " two  spaces ", store.text(odd));
+			TEST_NOT_EQUAL("distinct", odd, store.add("two spaces"));
+
+			std::stringstream out;
+			store.write(out, handles[0]);
+			TEST_EQUAL("write", (*all_foods)[0]->description(), out.str());
+		}
+	);
+
+	//
+	rubric.criterion(
+		"food generator", 2,
+		[&]()
+		{
+			FoodGenerator pantry(FoodDistribution::pantry, 42);
+			std::stringstream first, again, other_seed, tail;
+			TEST_TRUE("written", write_food_dataset(first, pantry, 0, 1000));
+			TEST_TRUE("written", write_food_dataset(again, FoodGenerator(FoodDistribution::pantry, 42), 0, 1000));
+			write_food_dataset(other_seed, FoodGenerator(FoodDistribution::pantry, 43), 0, 1000);
+			write_food_dataset(tail, pantry, 600, 400, false);
+			TEST_EQUAL("deterministic", first.str(), again.str());
+			TEST_NOT_EQUAL("seeded", first.str(), other_seed.str());
+			TEST_TRUE("rows addressable", first.str().size() > tail.str().size());
+			TEST_EQUAL("rows addressable", tail.str(), first.str().substr(first.str().size() - tail.str().size()));
+
+			const char* path = "maxcalorie_test_generated.csv";
+			for ( FoodDistribution distribution : { FoodDistribution::pantry, FoodDistribution::correlated,
+				FoodDistribution::inverse_correlated, FoodDistribution::subset_sum } )
+			{
+				FoodDistribution parsed;
+				TEST_TRUE("name", parse_food_distribution(food_distribution_name(distribution), parsed));
+				TEST_TRUE("name", distribution == parsed);
+
+				FoodGenerator generator(distribution, 7);
+				{
+					std::ofstream file(path, std::ios::binary);
+					write_food_dataset(file, generator, 0, 2000);
+				}
+				auto foods = load_food_database(path);
+				TEST_TRUE("loads", foods);
+				TEST_EQUAL("rows", 2000, foods->size());
+
+				std::string description;
+				FoodCenti weight, calories;
+				generator.row(1999, description, weight, calories);
+				TEST_EQUAL("description", description, foods->back()->description());
+				TEST_EQUAL("weight", FoodNumber<FoodCenti>::to_double(weight), foods->back()->weight());
+				TEST_EQUAL("calories", FoodNumber<FoodCenti>::to_double(calories), foods->back()->foodCalories());
+				if ( distribution == FoodDistribution::correlated )
+				{
+					TEST_EQUAL("correlated", weight + generator.range() / 10, calories);
+				}
+				else if ( distribution == FoodDistribution::subset_sum )
+				{
+					TEST_EQUAL("subset sum", weight, calories);
+				}
+			}
+			std::remove(path);
+			FoodDistribution unknown;
+			TEST_FALSE("unknown name", parse_food_distribution("uniform", unknown));
+		}
+	);
+
 	//
 	rubric.criterion(
 		"filter_food_vector", 2,
@@ -83,6 +570,15 @@ int main()
 			TEST_EQUAL("whole corn and pasta", 2, soln->size());
 			TEST_EQUAL("whole corn and pasta", "test whole corn", (*soln)[0]->description());
 			TEST_EQUAL("whole corn and pasta", "test pasta", (*soln)[1]->description());
+			TEST_TRUE("shares input items", (*soln)[0] == trivial_foods[0]);
+			TEST_TRUE("shares input items", (*soln)[1] == trivial_foods[1]);
+			
+			FoodVector ties(trivial_foods);
+			ties.push_back(std::shared_ptr<FoodItem>(new FoodItem("test half corn", 50.0, 10.0)));
+			soln = greedy_max_calories(ties, 150);
+			TEST_EQUAL("ties in input order", 2, soln->size());
+			TEST_EQUAL("ties in input order", "test whole corn", (*soln)[0]->description());
+			TEST_EQUAL("ties in input order", "test half corn", (*soln)[1]->description());
 		}
 	);
 	
@@ -125,6 +621,582 @@ int main()
 		}
 	);
 	
+	//
+	rubric.criterion(
+		"streaming filter and greedy", 2,
+		[&]()
+		{
+			auto ten = stream_filter_food_database("food.csv", 100, 500, 10);
+			auto expected_ten = filter_food_vector(*all_foods, 100, 500, 10);
+			TEST_TRUE("non-null", ten);
+			TEST_EQUAL("total_size", 10, ten->size());
+			for (int i = 0; i < 10; i++) {
+				TEST_EQUAL("contents", (*expected_ten)[i]->description(), (*ten)[i]->description());
+			}
+
+			size_t rows = 0;
+			TEST_TRUE("visit", visit_food_database("food.csv", [&](std::string_view, double, double) { return ++rows < 100; }));
+			TEST_EQUAL("stops early", 100, rows);
+
+			for (double total_weight : { 500.0, 5000.0, 50000.0 }) {
+				auto expected = greedy_max_calories(*all_foods, total_weight);
+				double expected_weight, expected_calories;
+				sum_food_vector(*expected, expected_weight, expected_calories);
+				for (size_t max_candidates : { size_t(2), size_t(64), size_t(1) << 16 }) {
+					auto soln = stream_greedy_max_calories("food.csv", total_weight, max_candidates);
+					TEST_TRUE("non-null", soln);
+					TEST_EQUAL("size", expected->size(), soln->size());
+					double weight, calories;
+					sum_food_vector(*soln, weight, calories);
+					TEST_TRUE("weight", std::abs(weight - expected_weight) < 1e-6);
+					TEST_TRUE("calories", std::abs(calories - expected_calories) < 1e-6);
+				}
+			}
+		}
+	);
+
+	//
+	rubric.criterion(
+		"FoodSelection", 2,
+		[&]()
+		{
+			auto ten = filter_food_selection(*all_foods, 100, 500, 10);
+			auto expected_ten = filter_food_vector(*all_foods, 100, 500, 10);
+			TEST_EQUAL("filter size", 10, ten.size());
+			for (int i = 0; i < 10; i++) {
+				TEST_EQUAL("filter shares items", (*expected_ten)[i], (*all_foods)[ten.index(i)]);
+			}
+
+			auto soln = greedy_max_calories_selection(trivial_foods, 150);
+			TEST_EQUAL("whole corn and pasta", 2, soln.size());
+			TEST_EQUAL("whole corn and pasta", "test whole corn", soln[0].description());
+			TEST_EQUAL("whole corn and pasta", "test pasta", soln[1].description());
+			TEST_EQUAL("view in place", trivial_foods[0].get(), &soln[0]);
+			TEST_EQUAL("shares items", trivial_foods[1], (*soln.to_food_vector())[1]);
+
+			for (double total_weight : { 500.0, 5000.0 }) {
+				double expected_weight, expected_calories, weight, calories;
+				sum_food_vector(*greedy_max_calories(*filtered_foods, total_weight), expected_weight, expected_calories);
+				sum_food_selection(greedy_max_calories_selection(*filtered_foods, total_weight), weight, calories);
+				TEST_TRUE("greedy weight", std::abs(weight - expected_weight) < 1e-6);
+				TEST_TRUE("greedy calories", std::abs(calories - expected_calories) < 1e-6);
+			}
+
+			for (int n = 1; n <= 12; n++) {
+				auto small_foods = filter_food_vector(*filtered_foods, 1, 2000, n);
+				auto expected = exhaustive_max_calories(*small_foods, 2000);
+				auto selection = exhaustive_max_calories_selection(*small_foods, 2000);
+				TEST_EQUAL("exhaustive size", expected->size(), selection.size());
+				for (size_t i = 0; i < selection.size(); i++) {
+					TEST_EQUAL("exhaustive contents", (*expected)[i].get(), &selection[i]);
+				}
+			}
+		}
+	);
+
+	//
+	rubric.criterion(
+		"DensityIndex", 2,
+		[&]()
+		{
+			DensityIndex index = build_density_index(*filtered_foods);
+			TEST_EQUAL("size", filtered_foods->size(), index.size());
+			TEST_EQUAL("prefix size", filtered_foods->size() + 1, index.prefix_weight.size());
+			for (double total_weight : { 0.0, 10.0, 500.0, 5000.0, 1e9 }) {
+				auto expected = greedy_max_calories_selection(*filtered_foods, total_weight);
+				auto soln = greedy_max_calories_selection(*filtered_foods, total_weight, index);
+				TEST_EQUAL("same selection", expected.indices(), soln.indices());
+			}
+			TEST_EQUAL("critical position", 0, index.critical_position(0));
+			TEST_EQUAL("critical position", index.size(), index.critical_position(1e9));
+
+			// Stored in, and read back from, a snapshot.
+			const char* csv_path = "maxcalorie_test_index.csv";
+			const char* snapshot_path = "maxcalorie_test_index.bin";
+			std::filesystem::copy_file("food.csv", csv_path, std::filesystem::copy_options::overwrite_existing);
+			TEST_TRUE("saved", save_food_snapshot(*all_foods, snapshot_path, csv_path));
+			auto snapshot = FoodSnapshot::open(snapshot_path, csv_path);
+			TEST_TRUE("opened", snapshot);
+			TEST_TRUE("has index", snapshot->has_density_index());
+			DensityIndex stored = snapshot->density_index();
+			DensityIndex built = build_density_index(*all_foods);
+			TEST_EQUAL("stored order", built.order, stored.order);
+			TEST_EQUAL("stored prefix", built.prefix_weight, stored.prefix_weight);
+			TEST_TRUE("saved without", save_food_snapshot(*all_foods, snapshot_path, csv_path, false));
+			TEST_FALSE("no index", FoodSnapshot::open(snapshot_path, csv_path)->has_density_index());
+			std::remove(csv_path);
+			std::remove(snapshot_path);
+
+			// A table's cached index follows changes to the table.
+			FoodTable table;
+			table.push_back("beans", 10, 10);
+			TEST_EQUAL("cached", 1, table.density_index().size());
+			table.push_back("rice", 1, 10);
+			TEST_EQUAL("invalidated", 2, table.density_index().size());
+			TEST_EQUAL("rice first", 1, table.density_index().order[0]);
+			TEST_EQUAL("rice first", "rice", greedy_max_calories(table, 5)->description(0));
+		}
+	);
+
+	//
+	rubric.criterion(
+		"radix_sort_density_keys", 2,
+		[&]()
+		{
+			TEST_TRUE("order", density_radix_key(2.5) < density_radix_key(1));
+			TEST_TRUE("order", density_radix_key(1) < density_radix_key(0));
+			TEST_TRUE("order", density_radix_key(0) < density_radix_key(-0.25));
+			TEST_TRUE("order", density_radix_key(-0.25) < density_radix_key(-3));
+			TEST_EQUAL("signed zero", density_radix_key(0.0), density_radix_key(-0.0));
+
+			std::vector<DensityKey> keys;
+			for (size_t i = 0; i < all_foods->size(); i++) {
+				keys.push_back({ (*all_foods)[i]->foodCalories() / (*all_foods)[i]->weight(), uint32_t(i) });
+			}
+			std::vector<double> odd = { 0.0, -0.0, 1.0, -1.0, 1e300, -1e300, 5e-324, 1.0, 0.0 };
+			for (double percent : odd) {
+				keys.push_back({ percent, uint32_t(keys.size()) });
+			}
+			for (size_t n : { size_t(0), size_t(1), size_t(2), size_t(100), keys.size() - odd.size(), keys.size() }) {
+				std::vector<DensityKey> expected(keys.begin(), keys.begin() + n), actual(expected);
+				std::sort(expected.begin(), expected.end(), density_key_before);
+				radix_sort_density_keys(actual);
+				bool same = true;
+				for (size_t i = 0; i < n; i++) {
+					same = same && expected[i].index == actual[i].index;
+				}
+				TEST_TRUE("same order as std::sort", same);
+			}
+		}
+	);
+
+	//
+	rubric.criterion(
+		"greedy_max_calories_batch", 2,
+		[&]()
+		{
+			std::vector<double> capacities;
+			for (double total_weight = 0; total_weight <= 20000; total_weight += 750) {
+				capacities.push_back(total_weight);
+			}
+			capacities.push_back(1e9);
+			for (unsigned threads : { 1u, 4u, 64u }) {
+				auto batch = greedy_max_calories_batch(*all_foods, capacities, threads);
+				TEST_EQUAL("one per capacity", capacities.size(), batch.size());
+				for (size_t q = 0; q < capacities.size(); q++) {
+					auto expected = greedy_max_calories(*all_foods, capacities[q]);
+					TEST_TRUE("non-null", batch[q]);
+					TEST_EQUAL("same as greedy_max_calories", *expected, *batch[q]);
+				}
+			}
+			TEST_TRUE("no capacities", greedy_max_calories_batch(*all_foods, {}).empty());
+		}
+	);
+
+	//
+	rubric.criterion(
+		"greedy_max_calories_partial", 2,
+		[&]()
+		{
+			// subset_sum items all have calories-per-weight 1, so every
+			// comparison is a tie.
+			FoodVector ties;
+			FoodGenerator generator(FoodDistribution::subset_sum, 3);
+			std::string description;
+			FoodCenti weight, calories;
+			for (uint64_t i = 0; i < 5000; i++) {
+				generator.row(i, description, weight, calories);
+				ties.push_back(std::make_shared<FoodItem>(description,
+					FoodNumber<FoodCenti>::to_double(weight), FoodNumber<FoodCenti>::to_double(calories)));
+			}
+
+			for (const FoodVector* foods : { all_foods.get(), &ties }) {
+				for (double total_weight : { 0.0, 50.0, 500.0, 5000.0, 100000.0, 1e9 }) {
+					auto expected = greedy_max_calories_selection(*foods, total_weight);
+					for (size_t first_batch : { 1, 7, 1024 }) {
+						auto soln = greedy_max_calories_partial_selection(*foods, total_weight, first_batch);
+						TEST_EQUAL("same selection", expected.indices(), soln.indices());
+					}
+				}
+			}
+			TEST_EQUAL("FoodVector", *greedy_max_calories(*all_foods, 2000), *greedy_max_calories_partial(*all_foods, 2000));
+		}
+	);
+
+	//
+	rubric.criterion(
+		"greedy_max_calories_parallel", 2,
+		[&]()
+		{
+			// Enough rows for several threads, with every density repeated.
+			FoodVector repeated;
+			for (int copy = 0; copy < 7; copy++) {
+				repeated.insert(repeated.end(), all_foods->begin(), all_foods->end());
+			}
+			for (double total_weight : { 0.0, 70.0, 5000.0, 300000.0, 1e9 }) {
+				auto expected = greedy_max_calories_selection(repeated, total_weight);
+				for (unsigned threads : { 1u, 2u, 3u, 8u, 64u }) {
+					auto soln = greedy_max_calories_parallel_selection(repeated, total_weight, threads);
+					TEST_EQUAL("same selection", expected.indices(), soln.indices());
+				}
+			}
+			TEST_EQUAL("FoodVector", *greedy_max_calories(*all_foods, 2000), *greedy_max_calories_parallel(*all_foods, 2000, 4));
+			TEST_TRUE("empty", greedy_max_calories_parallel(FoodVector(), 100, 4)->empty());
+		}
+	);
+
+	//
+	rubric.criterion(
+		"greedy_max_calories_approximation", 2,
+		[&]()
+		{
+			FoodVector trap;
+			trap.push_back(std::shared_ptr<FoodItem>(new FoodItem("test candy", 1.0, 2.0)));
+			trap.push_back(std::shared_ptr<FoodItem>(new FoodItem("test ham", 100.0, 100.0)));
+			trap.push_back(std::shared_ptr<FoodItem>(new FoodItem("test celery", 5.0, -1.0)));
+			auto approx = greedy_max_calories_approximation(trap, 100);
+			double greedy_weight, greedy_calories;
+			sum_food_vector(*greedy_max_calories(trap, 100), greedy_weight, greedy_calories);
+			TEST_EQUAL("greedy alone", 1, greedy_calories);
+			TEST_TRUE("single item", approx.single_item);
+			TEST_EQUAL("single item", 1, approx.selection.size());
+			TEST_EQUAL("single item", "test ham", approx.selection[0].description());
+			TEST_EQUAL("calories", 100, approx.calories);
+			TEST_EQUAL("Dantzig bound", 101, approx.upper_bound);
+			TEST_EQUAL("gap", 1, approx.gap());
+
+			auto nothing = greedy_max_calories_approximation(trap, 0.5);
+			TEST_TRUE("nothing fits", nothing.selection.empty());
+			TEST_EQUAL("nothing fits", 0, nothing.upper_bound);
+			TEST_EQUAL("everything fits", 0, greedy_max_calories_approximation(trap, 1000).gap());
+
+			// filtered_foods has only positive calories.
+			for (double total_weight : { 100.0, 500.0, 5000.0 }) {
+				auto result = greedy_max_calories_approximation(*filtered_foods, total_weight);
+				double weight, calories;
+				sum_food_selection(result.selection, weight, calories);
+				TEST_EQUAL("totals", calories, result.calories);
+				TEST_TRUE("fits", result.weight <= total_weight);
+				TEST_TRUE("bounded", result.calories <= result.upper_bound);
+				TEST_TRUE("half of the bound", 2 * result.calories >= result.upper_bound);
+				TEST_EQUAL("greedy when better", greedy_max_calories_selection(*filtered_foods, total_weight).indices(), result.selection.indices());
+			}
+			for (int n = 1; n <= 16; n++) {
+				auto small_foods = filter_food_vector(*filtered_foods, 1, 2000, n);
+				auto optimal = exhaustive_max_calories(*small_foods, 2000);
+				double weight, calories;
+				sum_food_vector(*optimal, weight, calories);
+				auto result = greedy_max_calories_approximation(*small_foods, 2000);
+				TEST_TRUE("optimum within bounds", result.calories <= calories + 1e-9 && calories <= result.upper_bound + 1e-9);
+			}
+		}
+	);
+
+	//
+	rubric.criterion(
+		"find_critical_item", 2,
+		[&]()
+		{
+			FoodVector ties;
+			FoodGenerator generator(FoodDistribution::subset_sum, 5);
+			std::string description;
+			FoodCenti weight, calories;
+			for (uint64_t i = 0; i < 3000; i++) {
+				generator.row(i, description, weight, calories);
+				ties.push_back(std::make_shared<FoodItem>(description,
+					FoodNumber<FoodCenti>::to_double(weight), FoodNumber<FoodCenti>::to_double(calories)));
+			}
+
+			for (const FoodVector* foods : { all_foods.get(), &ties }) {
+				for (double total_weight : { 0.5, 70.25, 5000.37, 123456.78, 1e9 }) {
+					// The same, by sorting.
+					std::vector<DensityKey> keys;
+					for (size_t i = 0; i < foods->size(); i++) {
+						const FoodItem& food = *(*foods)[i];
+						if (food.foodCalories() > 0 && food.weight() <= total_weight) {
+							keys.push_back({ food.foodCalories() / food.weight(), uint32_t(i) });
+						}
+					}
+					std::sort(keys.begin(), keys.end(), density_key_before);
+					std::vector<uint32_t> above;
+					double packed = 0;
+					size_t k = 0;
+					for (; k < keys.size() && packed + (*foods)[keys[k].index]->weight() <= total_weight; k++) {
+						packed += (*foods)[keys[k].index]->weight();
+						above.push_back(keys[k].index);
+					}
+					std::sort(above.begin(), above.end());
+
+					auto critical = find_critical_item(*foods, total_weight);
+					TEST_EQUAL("found", k < keys.size(), critical.found);
+					if (critical.found) {
+						TEST_EQUAL("critical item", keys[k].index, critical.index);
+					}
+					TEST_EQUAL("above", above, critical.above.indices());
+					double above_weight, above_calories;
+					sum_food_selection(critical.above, above_weight, above_calories);
+					TEST_TRUE("above weight", std::abs(above_weight - critical.above_weight) < 1e-6);
+					double bound = greedy_max_calories_approximation(*foods, total_weight).upper_bound;
+					TEST_TRUE("fractional bound", std::abs(bound - critical.fractional_bound) <= 1e-9 * std::max(1.0, bound));
+				}
+			}
+		}
+	);
+
+	//
+	rubric.criterion(
+		"DynamicFoodInventory", 2,
+		[&]()
+		{
+			DynamicFoodInventory inventory;
+			std::vector<FoodInventoryId> ids;
+			for (auto& food : *all_foods) {
+				ids.push_back(inventory.insert(food));
+			}
+			TEST_EQUAL("size", all_foods->size(), inventory.size());
+			TEST_EQUAL("insertion order", *all_foods, *inventory.to_food_vector());
+
+			// Ship every third item, then take donations of repeats.
+			for (size_t i = 0; i < ids.size(); i += 3) {
+				TEST_TRUE("removed", inventory.remove(ids[i]));
+			}
+			TEST_FALSE("removed twice", inventory.remove(ids[0]));
+			TEST_FALSE("unknown id", inventory.remove(1u << 30));
+			for (size_t i = 0; i < 1000; i++) {
+				inventory.insert((*all_foods)[i * 7 % all_foods->size()]);
+			}
+
+			auto current = inventory.to_food_vector();
+			TEST_EQUAL("size", current->size(), inventory.size());
+			double weight, calories;
+			sum_food_vector(*current, weight, calories);
+			TEST_TRUE("total weight", std::abs(weight - inventory.total_weight()) < 1e-6);
+			TEST_TRUE("total calories", std::abs(calories - inventory.total_calories()) < 1e-6);
+
+			for (double total_weight : { 0.0, 70.0, 500.0, 5000.0, 300000.0, 1e9 }) {
+				TEST_EQUAL("same as batch greedy", *greedy_max_calories(*current, total_weight),
+					*greedy_max_calories(inventory, total_weight));
+
+				double bound = greedy_max_calories_approximation(*current, total_weight).upper_bound;
+				TEST_TRUE("fractional bound", std::abs(bound - inventory.fractional_bound(total_weight)) <= 1e-9 * std::max(1.0, bound));
+			}
+
+			for (FoodInventoryId id : ids) {
+				inventory.remove(id);
+			}
+			TEST_EQUAL("donations left", 1000, inventory.size());
+		}
+	);
+
+	//
+	rubric.criterion(
+		"improve_food_selection", 2,
+		[&]()
+		{
+			const std::chrono::microseconds budget(100000);
+
+			FoodVector trap;
+			trap.push_back(std::shared_ptr<FoodItem>(new FoodItem("test candy", 1.0, 2.0)));
+			trap.push_back(std::shared_ptr<FoodItem>(new FoodItem("test ham", 100.0, 100.0)));
+			trap.push_back(std::shared_ptr<FoodItem>(new FoodItem("test celery", 5.0, -1.0)));
+			auto greedy = greedy_max_calories_selection(trap, 100);
+			TEST_EQUAL("greedy", 2, greedy.size());
+			auto improved = improve_food_selection(greedy, 100, budget);
+			TEST_TRUE("converged", improved.converged);
+			TEST_EQUAL("drop celery, swap candy for ham", 2, improved.moves);
+			TEST_EQUAL("ham", 1, improved.selection.size());
+			TEST_EQUAL("ham", "test ham", improved.selection[0].description());
+			TEST_EQUAL("calories", 100, improved.calories);
+
+			FoodVector pair;
+			pair.push_back(std::shared_ptr<FoodItem>(new FoodItem("test steak", 6.0, 7.0)));
+			pair.push_back(std::shared_ptr<FoodItem>(new FoodItem("test bread", 5.0, 5.0)));
+			pair.push_back(std::shared_ptr<FoodItem>(new FoodItem("test jam", 5.0, 5.0)));
+			auto steak = improve_food_selection(greedy_max_calories_selection(pair, 10), 10, budget);
+			TEST_TRUE("converged", steak.converged);
+			TEST_EQUAL("swap steak for bread and jam", 1, steak.moves);
+			TEST_EQUAL("bread and jam", 2, steak.selection.size());
+			TEST_EQUAL("calories", 10, steak.calories);
+
+			auto unchanged = improve_food_selection(greedy, 100, std::chrono::microseconds(0));
+			TEST_FALSE("no budget", unchanged.converged);
+			TEST_EQUAL("no budget", greedy.indices(), unchanged.selection.indices());
+
+			double greedy_total = 0, improved_total = 0, optimal_total = 0;
+			for (int n = 1; n <= 18; n++) {
+				auto small_foods = filter_food_vector(*all_foods, 1, 2500, n * 3);
+				small_foods->resize(n);
+				for (double total_weight : { 800.0, 2000.0 }) {
+					auto start = greedy_max_calories_selection(*small_foods, total_weight);
+					auto result = improve_food_selection(start, total_weight, budget);
+					double weight, calories;
+					sum_food_selection(result.selection, weight, calories);
+					TEST_TRUE("incremental totals", std::abs(weight - result.weight) < 1e-9 && std::abs(calories - result.calories) < 1e-9);
+					TEST_TRUE("fits", weight <= total_weight);
+
+					double start_weight, start_calories, optimal_weight, optimal_calories;
+					sum_food_selection(start, start_weight, start_calories);
+					sum_food_vector(*exhaustive_max_calories(*small_foods, total_weight), optimal_weight, optimal_calories);
+					TEST_TRUE("no worse than greedy", calories >= start_calories);
+					TEST_TRUE("no better than optimal", calories <= optimal_calories + 1e-9);
+					greedy_total += start_calories;
+					improved_total += calories;
+					optimal_total += optimal_calories;
+				}
+			}
+			// Most of greedy's gap to the optimum is closed.
+			TEST_TRUE("gap closed", optimal_total - improved_total < (optimal_total - greedy_total) / 2);
+
+			auto vector = greedy_max_calories_improved(*all_foods, 5000, budget);
+			double weight, calories;
+			sum_food_vector(*vector, weight, calories);
+			TEST_TRUE("FoodVector", weight <= 5000);
+		}
+	);
+
+	//
+	rubric.criterion(
+		"FoodTable", 2,
+		[&]()
+		{
+			auto table = make_food_table(*all_foods);
+			auto loaded = load_food_table("food.csv");
+			TEST_TRUE("non-null", loaded);
+			TEST_EQUAL("size", all_foods->size(), table->size());
+			TEST_EQUAL("size", all_foods->size(), loaded->size());
+			auto round_trip = to_food_vector(*loaded);
+			for (size_t i = 0; i < all_foods->size(); i++) {
+				TEST_EQUAL("description", (*all_foods)[i]->description(), (*round_trip)[i]->description());
+				TEST_EQUAL("weight", (*all_foods)[i]->weight(), (*round_trip)[i]->weight());
+				TEST_EQUAL("calories", (*all_foods)[i]->foodCalories(), table->foodCalories(i));
+			}
+
+			auto ten = filter_food_table(*table, 100, 500, 10);
+			auto expected_ten = filter_food_vector(*all_foods, 100, 500, 10);
+			TEST_EQUAL("filter size", 10, ten->size());
+			TEST_EQUAL("shared descriptions", table->shared_descriptions(), ten->shared_descriptions());
+			for (int i = 0; i < 10; i++) {
+				TEST_EQUAL("filter contents", (*expected_ten)[i]->description(), ten->description(i));
+			}
+
+			auto filtered_table = make_food_table(*filtered_foods);
+			for (double total_weight : { 500.0, 5000.0 }) {
+				double expected_weight, expected_calories, weight, calories;
+				sum_food_vector(*greedy_max_calories(*filtered_foods, total_weight), expected_weight, expected_calories);
+				sum_food_table(*greedy_max_calories(*filtered_table, total_weight), weight, calories);
+				TEST_TRUE("greedy weight", std::abs(weight - expected_weight) < 1e-6);
+				TEST_TRUE("greedy calories", std::abs(calories - expected_calories) < 1e-6);
+			}
+
+			for (int n = 1; n <= 12; n++) {
+				auto small_foods = filter_food_vector(*filtered_foods, 1, 2000, n);
+				auto small_table = filter_food_table(*filtered_table, 1, 2000, n);
+				auto expected = exhaustive_max_calories(*small_foods, 2000);
+				auto soln = exhaustive_max_calories(*small_table, 2000);
+				TEST_EQUAL("exhaustive size", expected->size(), soln->size());
+				for (size_t i = 0; i < soln->size(); i++) {
+					TEST_EQUAL("exhaustive contents", (*expected)[i]->description(), soln->description(i));
+				}
+			}
+
+			// Several threads building the cached index at once agree.
+			auto shared_table = make_food_table(*all_foods);
+			std::vector<std::unique_ptr<FoodTable>> answers(4);
+			std::vector<std::thread> threads;
+			for (size_t t = 0; t < answers.size(); t++) {
+				threads.emplace_back([&, t]() { answers[t] = greedy_max_calories(*shared_table, 5000); });
+			}
+			for (auto& thread : threads) {
+				thread.join();
+			}
+			auto expected_answer = greedy_max_calories(*all_foods, 5000);
+			for (auto& answer : answers) {
+				TEST_EQUAL("concurrent first use", expected_answer->size(), answer->size());
+			}
+		}
+	);
+
+	//
+	rubric.criterion(
+		"greedy kernels", 2,
+		[&]()
+		{
+			auto table = make_food_table(*all_foods);
+			size_t n = table->size();
+			const double* weights = table->weights();
+			const double* calories = table->calories();
+			const std::vector<uint32_t>& order = table->density_index().order;
+
+			std::vector<double> expected(n), actual(n);
+			food_densities_scalar(calories, weights, n, expected.data());
+			food_densities(calories, weights, n, actual.data());
+			TEST_EQUAL("densities", expected, actual);
+#ifdef MAXCALORIE_X86
+			for (size_t length : { size_t(0), size_t(3), size_t(13), n }) {
+				std::vector<double> avx(length);
+				if ( cpu_has_avx2() ) {
+					food_densities_avx2(calories, weights, length, avx.data());
+					TEST_TRUE("avx2 densities", std::equal(avx.begin(), avx.end(), expected.begin()));
+				}
+				if ( cpu_has_avx512f() ) {
+					food_densities_avx512(calories, weights, length, avx.data());
+					TEST_TRUE("avx512 densities", std::equal(avx.begin(), avx.end(), expected.begin()));
+				}
+			}
+#endif
+
+			for (double capacity : { 0.0, 1000.0, 4900.0, 4990.0 }) {
+				for (size_t begin : { size_t(0), size_t(5), n - 9, n }) {
+					size_t k = find_fitting_food_scalar(weights, order.data(), begin, n, capacity, 5000);
+					TEST_EQUAL("next fitting", k, find_fitting_food(weights, order.data(), begin, n, capacity, 5000, n));
+#ifdef MAXCALORIE_X86
+					if ( cpu_has_avx2() ) {
+						TEST_EQUAL("avx2 next fitting", k, find_fitting_food_avx2(weights, order.data(), begin, n, capacity, 5000));
+					}
+					if ( cpu_has_avx512f() ) {
+						TEST_EQUAL("avx512 next fitting", k, find_fitting_food_avx512(weights, order.data(), begin, n, capacity, 5000));
+					}
+#endif
+				}
+			}
+			TEST_EQUAL("none fits", n, find_fitting_food(weights, order.data(), 0, n, 0, 1, n));
+		}
+	);
+
+	//
+	rubric.criterion(
+		"FixedFoodTable", 2,
+		[&]()
+		{
+			FoodCenti value;
+			TEST_TRUE("two decimals", FoodNumber<FoodCenti>::from_double(609.3, value));
+			TEST_EQUAL("two decimals", 60930, value);
+			TEST_FALSE("three decimals", FoodNumber<FoodCenti>::from_double(1.005, value));
+
+			auto fixed = load_food_table<FoodCenti>("food.csv");
+			TEST_TRUE("non-null", fixed);
+			TEST_EQUAL("size", all_foods->size(), fixed->size());
+			for (size_t i = 0; i < fixed->size(); i++) {
+				TEST_EQUAL("weight", (*all_foods)[i]->weight(), FoodNumber<FoodCenti>::to_double(fixed->weight(i)));
+			}
+
+			// The expectations of "greedy_max_calories correctness", with no
+			// rounding.
+			auto filtered = filter_food_table(*fixed, 100, 250000, fixed->size());
+			FoodCenti weight, calories;
+			sum_food_table(*greedy_max_calories(*filtered, 50000), weight, calories);
+			TEST_EQUAL("Small solution weight", 48148, weight);
+			TEST_EQUAL("Small solution calories", 95019, calories);
+			sum_food_table(*greedy_max_calories(*filtered, 500000), weight, calories);
+			TEST_EQUAL("Large solution weight", 499035, weight);
+			TEST_EQUAL("Large solution calories", 920982, calories);
+
+			auto small = filter_food_table(*filtered, 100, 200000, 2);
+			sum_food_table(*exhaustive_max_calories(*small, 200000), weight, calories);
+			TEST_EQUAL("exhaustive n = 2", 103305, calories);
+		}
+	);
+
 	//
 	rubric.criterion(
 		"exhaustive_max_calories trivial cases", 2,